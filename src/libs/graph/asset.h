@@ -4,12 +4,26 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include "../misc/uint256.h"
+
 struct Asset {
-    std::string quoteId{};
-    std::string poolID{};
-    std::string protocol{};
     std::string symbol{};
     std::string address{};
     int64_t decimals{};
-    double derivedETH;
-};
\ No newline at end of file
+    double derivedETH{};
+};
+
+struct Pool {
+    std::string quoteId{};
+    std::string poolID{};
+    std::string protocol{};
+    uint32_t token0{};      // asset id of token0
+    uint32_t token1{};      // asset id of token1
+    double reserve0{};      // token0 held by the pool, in token units
+    double reserve1{};      // token1 held by the pool, in token units
+    utils::uint256 reserve0Raw{};   // token0 held by the pool, in its smallest unit as on chain
+    utils::uint256 reserve1Raw{};   // token1 held by the pool, in its smallest unit as on chain
+    double fee{};           // fraction of the input taken by a swap
+};
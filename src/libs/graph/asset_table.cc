@@ -0,0 +1,70 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 asset_table.cc -std=c++17
+ *  Dependencies: asset.h directed_edge.h
+ *
+ *  Interned assets and pools of a graph snapshot.
+ *
+ ******************************************************************************/
+
+#include "asset_table.h"
+
+using std::string;
+
+/**
+ * Interns an asset of the given protocol.
+ *
+ * @param  protocol the protocol the asset is quoted on
+ * @param  asset the asset
+ * @return the id of the asset
+ */
+uint32_t AssetTable::addAsset(const string &protocol, const Asset &asset) {
+    string key;
+    key.append(protocol).append("_").append(asset.address);
+    auto it = _asset_index.find(key);
+    if (it != _asset_index.end()) return it->second;
+
+    auto id = static_cast<uint32_t>(_assets.size());
+    _assets.push_back(asset);
+    _asset_index.emplace(std::move(key), id);
+    return id;
+}
+
+/**
+ * Interns a pool, whose {@code token0} and {@code token1} are asset ids of this table.
+ *
+ * @param  pool the pool
+ * @return the id of the pool
+ */
+uint32_t AssetTable::addPool(const Pool &pool) {
+    auto it = _pool_index.find(pool.quoteId);
+    if (it != _pool_index.end()) return it->second;
+
+    auto id = static_cast<uint32_t>(_pools.size());
+    _pools.push_back(pool);
+    _pool_index.emplace(pool.quoteId, id);
+    return id;
+}
+
+/**
+ * Looks up a pool by quote id.
+ *
+ * @param  quoteId the quote id of the pool
+ * @param  id set to the id of the pool when it is known
+ * @return {@code true} if the pool is in the table
+ */
+bool AssetTable::findPool(const string &quoteId, uint32_t &id) const {
+    auto it = _pool_index.find(quoteId);
+    if (it == _pool_index.end()) return false;
+    id = it->second;
+    return true;
+}
+
+/**
+ * Removes every asset and pool from the table.
+ */
+void AssetTable::clear() {
+    _assets.clear();
+    _pools.clear();
+    _asset_index.clear();
+    _pool_index.clear();
+}
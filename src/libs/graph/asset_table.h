@@ -0,0 +1,139 @@
+/**
+ *  The {@code AssetTable} class interns the assets and pools of a snapshot
+ *  and hands out dense 32-bit ids for them, so that a {@link DirectedEdge}
+ *  only needs to carry a pool id instead of copies of both of its assets.
+ *  Assets are keyed by protocol and address, pools by quote id; adding an
+ *  asset or a pool that is already known returns its existing id.
+ *  <p>
+ *  All accessors return references into the table, which stay valid
+ *  until the table is cleared.
+ */
+
+#ifndef ASSET_TABLE_H
+#define ASSET_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "asset.h"
+#include "directed_edge.h"
+
+class AssetTable {
+public:
+    /**
+     * Interns an asset of the given protocol.
+     *
+     * @param  protocol the protocol the asset is quoted on
+     * @param  asset the asset
+     * @return the id of the asset
+     */
+    uint32_t addAsset(const std::string &protocol, const Asset &asset);
+
+    /**
+     * Interns a pool, whose {@code token0} and {@code token1} are asset ids of this table.
+     *
+     * @param  pool the pool
+     * @return the id of the pool
+     */
+    uint32_t addPool(const Pool &pool);
+
+    /**
+     * Returns the asset with the given id.
+     *
+     * @param  id the asset id
+     * @return the asset
+     */
+    [[nodiscard]] const Asset &asset(uint32_t id) const { return _assets[id]; }
+
+    /**
+     * Returns the asset with the given id, for updating its quote.
+     *
+     * @param  id the asset id
+     * @return the asset
+     */
+    [[nodiscard]] Asset &asset(uint32_t id) { return _assets[id]; }
+
+    /**
+     * Returns the pool with the given id.
+     *
+     * @param  id the pool id
+     * @return the pool
+     */
+    [[nodiscard]] const Pool &pool(uint32_t id) const { return _pools[id]; }
+
+    /**
+     * Returns the pool with the given id, for updating its reserves.
+     *
+     * @param  id the pool id
+     * @return the pool
+     */
+    [[nodiscard]] Pool &pool(uint32_t id) { return _pools[id]; }
+
+    /**
+     * Looks up a pool by quote id.
+     *
+     * @param  quoteId the quote id of the pool
+     * @param  id set to the id of the pool when it is known
+     * @return {@code true} if the pool is in the table
+     */
+    bool findPool(const std::string &quoteId, uint32_t &id) const;
+
+    /**
+     * Returns the pool an edge swaps through.
+     *
+     * @param  e the edge
+     * @return the pool of the edge
+     */
+    [[nodiscard]] const Pool &pool(const DirectedEdge &e) const { return _pools[e.pool()]; }
+
+    /**
+     * Returns the asset sold along an edge.
+     *
+     * @param  e the edge
+     * @return the from asset of the edge
+     */
+    [[nodiscard]] const Asset &from(const DirectedEdge &e) const {
+        const Pool &p = pool(e);
+        return _assets[e.zero_for_one() ? p.token0 : p.token1];
+    }
+
+    /**
+     * Returns the asset bought along an edge.
+     *
+     * @param  e the edge
+     * @return the to asset of the edge
+     */
+    [[nodiscard]] const Asset &to(const DirectedEdge &e) const {
+        const Pool &p = pool(e);
+        return _assets[e.zero_for_one() ? p.token1 : p.token0];
+    }
+
+    /**
+     * Returns the number of interned assets.
+     *
+     * @return the number of assets
+     */
+    [[nodiscard]] size_t assets() const { return _assets.size(); }
+
+    /**
+     * Returns the number of interned pools.
+     *
+     * @return the number of pools
+     */
+    [[nodiscard]] size_t pools() const { return _pools.size(); }
+
+    /**
+     * Removes every asset and pool from the table.
+     */
+    void clear();
+
+private:
+    std::vector<Asset> _assets;                              // assets[id] = asset
+    std::vector<Pool> _pools;                                // pools[id] = pool
+    std::unordered_map<std::string, uint32_t> _asset_index;  // protocol_address -> asset id
+    std::unordered_map<std::string, uint32_t> _pool_index;   // quote id -> pool id
+};
+
+#endif
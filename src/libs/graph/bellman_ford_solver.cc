@@ -0,0 +1,158 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 directed_edge.cc -std=c++17
+ *                clang++ -c -O2 edge_weighted_digraph.cc -std=c++17
+ *                clang++ -c -O2 csr_digraph.cc -std=c++17
+ *                clang++ -c -O2 bellman_ford_solver.cc -std=c++17
+ *  Dependencies: csr_digraph.h directed_edge.h
+ *
+ *  Bellman-Ford-Moore single-source search on a reusable workspace:
+ *  retargeted with run(s), it resets only what the previous run touched.
+ *
+ ******************************************************************************/
+
+#include "bellman_ford_solver.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "directed_edge.h"
+
+using std::stack;
+using std::vector;
+
+/**
+ * Allocates a workspace for the searches on the frozen digraph {@code G}.
+ * @param G the digraph in compressed sparse row form
+ */
+BellmanFordSolver::BellmanFordSolver(const CsrDigraph &G)
+        : _G(G), _capacity(G.V()),
+          _distTo(G.V(), std::numeric_limits<double>::max()),
+          _edgeTo(G.V(), -1),
+          _from(G.E()),
+          _onQueue((G.V() + 63) / 64),
+          _queue(std::max(1, G.V())),
+          _stamp(G.V()) {
+    for (int v = 0; v < G.V(); v++)
+        for (int i = G.offsets()[v]; i < G.offsets()[v + 1]; i++)
+            _from[i] = v;
+    _touched.reserve(G.V());
+    _cycle.reserve(G.V());
+}
+
+/**
+ * Computes a shortest paths tree from {@code s} to every other vertex,
+ * or finds a negative cycle reachable from {@code s}.
+ * @param  s the source vertex
+ * @return {@code true} if there is a negative cycle reachable from {@code s}
+ * @throws IllegalArgumentException unless {@code 0 <= s < V}
+ */
+bool BellmanFordSolver::run(int s) {
+    validateVertex(s);
+
+    // forget the previous run: the vertices it reached, and the queue it left behind on a cycle
+    for (int v : _touched) {
+        _distTo[v] = std::numeric_limits<double>::max();
+        _edgeTo[v] = -1;
+    }
+    _touched.clear();
+    for (; _size > 0; _size--) {
+        _onQueue[_queue[_head] >> 6] = 0;
+        if (++_head == _capacity) _head = 0;
+    }
+    _head = _tail = 0;
+    _cost = 0;
+    _cycle.clear();
+
+    _distTo[s] = 0.0;
+    _touched.push_back(s);
+    enqueue(s);
+
+    // Bellman-Ford algorithm
+    while (_size > 0) {
+        int v = _queue[_head];
+        if (++_head == _capacity) _head = 0;
+        _size--;
+        _onQueue[v >> 6] &= ~(uint64_t(1) << (v & 63));
+        if (relax(v)) return true;
+    }
+    return false;
+}
+
+// relax vertex v and put other endpoints on queue if changed;
+// true once a negative cycle has been found
+bool BellmanFordSolver::relax(int v) {
+    const int *offsets = _G.offsets();
+    const int *to = _G.to();
+    const double *weight = _G.weight();
+    for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+        int w = to[i];
+        if (_distTo[w] > _distTo[v] + weight[i]) {
+            if (_distTo[w] == std::numeric_limits<double>::max()) _touched.push_back(w);
+            _distTo[w] = _distTo[v] + weight[i];
+            _edgeTo[w] = i;
+            enqueue(w);
+        }
+        if (++_cost % _capacity == 0 && findNegativeCycle()) return true;
+    }
+    return false;
+}
+
+// by walking the parent slots of the reached vertices: a walk that comes back
+// to a vertex it stamped itself has closed a cycle
+bool BellmanFordSolver::findNegativeCycle() {
+    uint64_t first = _walk + 1;    // walks of this check are numbered from here
+    for (int v : _touched) {
+        if (_stamp[v] >= first) continue;
+
+        uint64_t walk = ++_walk;
+        int x = v;
+        while (x >= 0 && _stamp[x] < first) {
+            _stamp[x] = walk;
+            x = _edgeTo[x] < 0 ? -1 : _from[_edgeTo[x]];
+        }
+        if (x < 0 || _stamp[x] != walk) continue;
+
+        // x is on the cycle, collect its slots backwards then put them in path order
+        int y = x;
+        do {
+            _cycle.push_back(_edgeTo[y]);
+            y = _from[_edgeTo[y]];
+        } while (y != x);
+        std::reverse(_cycle.begin(), _cycle.end());
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Returns the negative cycle found by the last run, as {@link BellmanFordSP} does.
+ * @return the negative cycle as an iterable of edges, empty if there is no such cycle
+ */
+stack<DirectedEdge *> BellmanFordSolver::negativeCycle() const {
+    stack<DirectedEdge *> cycle;
+    for (auto i = _cycle.rbegin(); i != _cycle.rend(); ++i)
+        cycle.push(_G.edge(*i));
+    return cycle;
+}
+
+/**
+ * Returns the length of a shortest path from the source of the last run to vertex {@code v}.
+ * @param  v the destination vertex
+ * @return the length of a shortest path to vertex {@code v};
+ *         {@code Double.POSITIVE_INFINITY} if no such path
+ * @throws UnsupportedOperationException if the last run found a negative cycle
+ * @throws IllegalArgumentException unless {@code 0 <= v < V}
+ */
+double BellmanFordSolver::distTo(int v) const {
+    validateVertex(v);
+    if (hasNegativeCycle())
+        throw "Negative cost cycle exists";
+    return _distTo[v];
+}
+
+// throw an IllegalArgumentException unless {@code 0 <= v < V}
+void BellmanFordSolver::validateVertex(int v) const {
+    if (v < 0 || v >= _capacity)
+        throw std::invalid_argument("vertex " + std::to_string(v) + " is not between 0 and " + std::to_string(_capacity - 1));
+}
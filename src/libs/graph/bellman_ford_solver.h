@@ -0,0 +1,124 @@
+/**
+ *  The {@code BellmanFordSolver} class is a reusable workspace for the
+ *  single-source Bellman-Ford-Moore search of {@link BellmanFordSP} on a
+ *  {@link CsrDigraph}. It is built once for a digraph and retargeted with
+ *  {@code run(s)}, so that the thousands of sources searched every cycle
+ *  share the same arrays instead of allocating and freeing their own.
+ *  <p>
+ *  Distances and parent slots are flat arrays, the queue membership is a bitset
+ *  and the FIFO queue is a ring buffer of <em>V</em> entries, enough as a vertex
+ *  is never on the queue twice. Every vertex reached by a run is recorded, and
+ *  only those are reset by the next run, so a run costs time proportional to the
+ *  part of the digraph it explores and performs no allocation at all.
+ *  <p>
+ *  As in {@link BellmanFordSP} the search stops at the first negative cycle
+ *  reachable from the source. The periodic check for it walks the parent
+ *  slots in place, marking the vertices with generation stamps.
+ *  The cycle is kept as edge slots; {@code negativeCycle()} only builds the
+ *  stack of edges when asked.
+ */
+
+#ifndef BELLMAN_FORD_SOLVER_H
+#define BELLMAN_FORD_SOLVER_H
+
+#include <cstdint>
+#include <limits>
+#include <stack>
+#include <vector>
+
+#include "csr_digraph.h"
+
+class DirectedEdge;
+
+class BellmanFordSolver {
+public:
+    /**
+     * Allocates a workspace for the searches on the frozen digraph {@code G}.
+     * @param G the digraph in compressed sparse row form
+     */
+    explicit BellmanFordSolver(const CsrDigraph &G);
+    /**
+     * Computes a shortest paths tree from {@code s} to every other vertex,
+     * or finds a negative cycle reachable from {@code s}.
+     * @param  s the source vertex
+     * @return {@code true} if there is a negative cycle reachable from {@code s}
+     * @throws IllegalArgumentException unless {@code 0 <= s < V}
+     */
+    bool run(int s);
+    /**
+     * Is there a negative cycle reachable from the source of the last run?
+     * @return {@code true} if the last run found a negative cycle
+     */
+    bool hasNegativeCycle() const { return !_cycle.empty(); }
+    /**
+     * Returns the edge slots of the negative cycle found by the last run,
+     * the first slot leaving the vertex the cycle was closed on.
+     * @return the edge slots of the cycle, empty if there is no such cycle
+     */
+    const std::vector<int> &negativeCycleSlots() const { return _cycle; }
+    /**
+     * Returns the negative cycle found by the last run, as {@link BellmanFordSP} does.
+     * @return the negative cycle as an iterable of edges, empty if there is no such cycle
+     */
+    std::stack<DirectedEdge *> negativeCycle() const;
+    /**
+     * Returns the length of a shortest path from the source of the last run to vertex {@code v}.
+     * @param  v the destination vertex
+     * @return the length of a shortest path to vertex {@code v};
+     *         {@code Double.POSITIVE_INFINITY} if no such path
+     * @throws UnsupportedOperationException if the last run found a negative cycle
+     * @throws IllegalArgumentException unless {@code 0 <= v < V}
+     */
+    double distTo(int v) const;
+    /**
+     * Is there a path from the source of the last run to vertex {@code v}?
+     * @param  v the destination vertex
+     * @return {@code true} if there is a path to vertex {@code v}
+     * @throws IllegalArgumentException unless {@code 0 <= v < V}
+     */
+    bool hasPathTo(int v) const {
+        validateVertex(v);
+        return _distTo[v] < std::numeric_limits<double>::max();
+    }
+    /**
+     * Returns the number of vertices reached by the last run.
+     * @return the number of vertices reached by the last run
+     */
+    int reached() const { return _touched.size(); }
+
+private:
+    // relax vertex v and put other endpoints on queue if changed
+    bool relax(int v);
+    // by walking the parent slots of the reached vertices
+    bool findNegativeCycle();
+    // put w on the ring buffer unless it is already there
+    void enqueue(int w) {
+        uint64_t bit = uint64_t(1) << (w & 63);
+        if (_onQueue[w >> 6] & bit) return;
+        _onQueue[w >> 6] |= bit;
+        _queue[_tail] = w;
+        if (++_tail == _capacity) _tail = 0;
+        _size++;
+    }
+    // throw an IllegalArgumentException unless {@code 0 <= v < V}
+    void validateVertex(int v) const;
+
+private:
+    const CsrDigraph &_G;
+    int _capacity;                  // number of vertices, and of ring buffer entries
+    std::vector<double> _distTo;    // distTo[v] = distance of shortest s->v path
+    std::vector<int> _edgeTo;       // edgeTo[v] = last slot on shortest s->v path, -1 if none
+    std::vector<int> _from;         // from[i] = tail vertex of edge slot i
+    std::vector<uint64_t> _onQueue; // bit v = is v currently on the queue?
+    std::vector<int> _queue;        // ring buffer of vertices to relax
+    int _head = 0;
+    int _tail = 0;
+    int _size = 0;
+    std::vector<int> _touched;      // vertices reached by the current run
+    std::vector<uint64_t> _stamp;   // last parent walk through v
+    uint64_t _walk = 0;             // number of parent walks so far
+    long _cost = 0;                 // number of calls to relax() in the current run
+    std::vector<int> _cycle;        // slots of the negative cycle, empty if none
+};
+
+#endif
@@ -1,11 +1,9 @@
 /******************************************************************************
  *  Compilation:  clang++ -c -O2 directed_edge.cc -std=c++11
  *                clang++ -c -O2 edge_weighted_digraph.cc -std=c++11
- *                clang++ -c -O2 edge_weighted_directed_cycle.cc -std=c++11
- *                clang++ -O2 -DDebug bellman_ford_sp.cc edge_weighted_directed_cycle.o edge_weighted_digraph.o directed_edge.o -std=c++11 -o bellman_ford_sp
+ *                clang++ -O2 -DDebug bellman_ford_sp.cc edge_weighted_digraph.o directed_edge.o -std=c++11 -o bellman_ford_sp
  *  Execution:    bellman_ford_sp filename.txt s
  *  Dependencies: edge_weighted_digraph.h directed_edge.h
- *                edge_weighted_directed_cycle.h
  *  Data files:   https://algs4.cs.princeton.edu/44sp/tinyEWDn.txt
  *                https://algs4.cs.princeton.edu/44sp/mediumEWDnc.txt
  *
@@ -71,38 +69,85 @@
 #include <exception>
 
 #include "directed_edge.h"
-#include "edge_weighted_directed_cycle.h"
 
 using std::vector;
 using std::queue;
 using std::stack;
 
-BellmanFordSP::BellmanFordSP(const EdgeWeightedDigraph &G, int s) {
+BellmanFordSP::BellmanFordSP(const EdgeWeightedDigraph &G, int s) : _source(s) {
+    search(G);
+}
+
+/**
+ * Computes shortest paths from a virtual super-source, linked to every vertex
+ * of {@code G} by a zero-weight edge, and collects every negative cycle
+ * of the digraph in a single pass.
+ * @param G the edge-weighted digraph
+ */
+BellmanFordSP::BellmanFordSP(const EdgeWeightedDigraph &G) {
+    search(G);
+}
+
+/**
+ * Computes a shortest paths tree from {@code s} to every other vertex in
+ * the frozen digraph {@code G}, relaxing straight over its edge arrays.
+ * @param G the digraph in compressed sparse row form
+ * @param s the source vertex
+ * @throws IllegalArgumentException unless {@code 0 <= s < V}
+ */
+BellmanFordSP::BellmanFordSP(const CsrDigraph &G, int s) : _source(s) {
+    search(G);
+}
+
+/**
+ * Collects every negative cycle of the frozen digraph {@code G} from a virtual super-source.
+ * @param G the digraph in compressed sparse row form
+ */
+BellmanFordSP::BellmanFordSP(const CsrDigraph &G) {
+    search(G);
+}
+
+// run the queue-based Bellman-Ford algorithm from the source (or super-source)
+template<typename Digraph>
+void BellmanFordSP::search(const Digraph &G) {
     _distTo.resize(G.V());
     _edgeTo.resize(G.V());
     _onQueue.resize(G.V());
-    for (int v = 0; v < G.V(); v++)
-        _distTo[v] = std::numeric_limits<double>::max();
-    _distTo[s] = 0.0;
+    _blocked.resize(G.V());
+    _stamp.resize(G.V());
+
+    if (_source >= 0) {
+        for (int v = 0; v < G.V(); v++)
+            _distTo[v] = std::numeric_limits<double>::max();
+        _distTo[_source] = 0.0;
+        _queue.push(_source);
+        _onQueue[_source] = true;
+    } else {
+        // the super-source reaches every vertex through a zero-weight edge
+        for (int v = 0; v < G.V(); v++) {
+            _distTo[v] = 0.0;
+            _queue.push(v);
+            _onQueue[v] = true;
+        }
+    }
 
     // Bellman-Ford algorithm
-    _queue.push(s);
-    _onQueue[s] = true;
-    while (!_queue.empty() && !hasNegativeCycle()) {
+    while (!_queue.empty() && !(_source >= 0 && hasNegativeCycle())) {
         int v = _queue.front();
         _queue.pop();
         _onQueue[v] = false;
-        relax(G, v);
+        if (!_blocked[v]) relax(G, v);
     }
 
-    //assert(check(G, s));
-    check(G, s);
+    //assert(check(G, _source));
+    check(G, _source);
 }
 
 // relax vertex v and put other endpoints on queue if changed
 void BellmanFordSP::relax(const EdgeWeightedDigraph &G, int v) {
     for (DirectedEdge *e : G.adj(v)) {
         int w = e->to();
+        if (_blocked[w]) continue;       // already part of a reported cycle
         if (_distTo[w] > _distTo[v] + e->weight()) {
             _distTo[w] = _distTo[v] + e->weight();
             _edgeTo[w] = e;
@@ -113,20 +158,73 @@ void BellmanFordSP::relax(const EdgeWeightedDigraph &G, int v) {
         }
         if (_cost++ % G.V() == 0) {
             findNegativeCycle();
-            if (hasNegativeCycle()) return;  // found a negative cycle
+            if (_source >= 0 && hasNegativeCycle()) return;  // found a negative cycle
+            if (_blocked[v]) return;  // v has just been retired with its cycle
+        }
+    }
+}
+
+// same as above, reading the head vertices and weights from the CSR arrays
+void BellmanFordSP::relax(const CsrDigraph &G, int v) {
+    const int *offsets = G.offsets();
+    const int *to = G.to();
+    const double *weight = G.weight();
+    for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+        int w = to[i];
+        if (_blocked[w]) continue;       // already part of a reported cycle
+        if (_distTo[w] > _distTo[v] + weight[i]) {
+            _distTo[w] = _distTo[v] + weight[i];
+            _edgeTo[w] = G.edge(i);
+            if (!_onQueue[w]) {
+                _queue.push(w);
+                _onQueue[w] = true;
+            }
+        }
+        if (_cost++ % G.V() == 0) {
+            findNegativeCycle();
+            if (_source >= 0 && hasNegativeCycle()) return;  // found a negative cycle
+            if (_blocked[v]) return;  // v has just been retired with its cycle
         }
     }
 }
 
-// by finding a cycle in predecessor graph
+// by finding a cycle in predecessor graph, walking the edgeTo[] pointers in place:
+// a walk that comes back to a vertex it stamped itself has closed a cycle, a walk
+// that reaches the source, a retired vertex or a vertex stamped by an earlier walk
+// of the same check stops there, so a check takes time proportional to V
 void BellmanFordSP::findNegativeCycle() {
     int V = _edgeTo.size();
-    EdgeWeightedDigraph spt(V);
-    for (int v = 0; v < V; v++)
-        if (_edgeTo[v] != nullptr) spt.addEdge(_edgeTo[v]);
+    uint64_t first = _walk + 1;    // walks of this check are numbered from here
+
+    for (int v = 0; v < V; v++) {
+        if (_blocked[v] || _stamp[v] >= first) continue;
 
-    EdgeWeightedDirectedCycle finder(spt);
-    _cycle = finder.cycle();
+        uint64_t walk = ++_walk;
+        int x = v;
+        while (x >= 0 && !_blocked[x] && _stamp[x] < first) {
+            _stamp[x] = walk;
+            x = _edgeTo[x] == nullptr ? -1 : _edgeTo[x]->from();
+        }
+        if (x < 0 || _blocked[x] || _stamp[x] != walk) continue;
+
+        // x is on the cycle, walking back from it leaves the edge leaving x on top
+        stack<DirectedEdge *> cycle;
+        int y = x;
+        do {
+            cycle.push(_edgeTo[y]);
+            y = _edgeTo[y]->from();
+        } while (y != x);
+
+        if (_cycles.empty()) _cycle = cycle;
+        _cycles.emplace_back(cycle);
+        if (_source >= 0) return;
+
+        // super-source: retire the vertices of the cycle and look for the others
+        do {
+            _blocked[y] = true;
+            y = _edgeTo[y]->from();
+        } while (y != x);
+    }
 }
 
 /**
@@ -172,27 +270,31 @@ vector<DirectedEdge *> BellmanFordSP::pathTo(int v) const {
 //     or
 // (ii)  for all edges e = v->w:            distTo[w] <= distTo[v] + e.weight()
 // (ii') for all edges e = v->w on the SPT: distTo[w] == distTo[v] + e.weight()
-bool BellmanFordSP::check(const EdgeWeightedDigraph &G, int s) {
+template<typename Digraph>
+bool BellmanFordSP::check(const Digraph &G, int s) {
     // has a negative cycle
     if (hasNegativeCycle()) {
-        double weight = 0.0;
-        stack<DirectedEdge *> edges(negativeCycle());
-        while (!edges.empty()) {
-            weight += edges.top()->weight();
-            edges.pop();
-        }
-        if (weight >= 0.0) {
-            //printf("error: weight of negative cycle = %lf\n", weight);
-            return false;
+        for (const stack<DirectedEdge *> &cycle : _cycles) {
+            double weight = 0.0;
+            stack<DirectedEdge *> edges(cycle);
+            while (!edges.empty()) {
+                weight += edges.top()->weight();
+                edges.pop();
+            }
+            if (weight >= 0.0) {
+                //printf("error: weight of negative cycle = %lf\n", weight);
+                return false;
+            }
         }
     } else { // no negative cycle reachable from source
         // check that distTo[v] and edgeTo[v] are consistent
-        if (_distTo[s] != 0.0 || _edgeTo[s] != nullptr) {
+        if (s >= 0 && (_distTo[s] != 0.0 || _edgeTo[s] != nullptr)) {
             printf("distanceTo[s] and edgeTo[s] inconsistent\n %f %s\n", _distTo[s], _edgeTo[s]->toString().c_str());
             return false;
         }
 
-        for (int v = 0; v < G.V(); v++) {
+        // with a super-source every vertex is reachable, so there is nothing to check
+        for (int v = 0; s >= 0 && v < G.V(); v++) {
             if (v == s) continue;
             if (_edgeTo[v] == nullptr && _distTo[v] != std::numeric_limits<double>::max()) {
                 printf("distTo[] and edgeTo[] inconsistent\n %f %s\n", _distTo[v], _edgeTo[s]->toString().c_str());
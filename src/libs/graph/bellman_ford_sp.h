@@ -26,12 +26,14 @@
 #ifndef BELLMAN_FORD_SP_H
 #define BELLMAN_FORD_SP_H
 
+#include <cstdint>
 #include <vector>
 #include <queue>
 #include <stack>
 #include <limits>
 
 #include "edge_weighted_digraph.h"
+#include "csr_digraph.h"
 
 class DirectedEdge;
 
@@ -45,6 +47,27 @@ public:
      * @throws IllegalArgumentException unless {@code 0 <= s < V}
      */
     BellmanFordSP(const EdgeWeightedDigraph& G, int s);
+    /**
+     * Computes shortest paths from a virtual super-source, linked to every vertex
+     * of {@code G} by a zero-weight edge, and collects every negative cycle
+     * of the digraph in a single pass. The vertices of a cycle are retired
+     * as soon as it is found, so that the search carries on looking for the others.
+     * @param G the edge-weighted digraph
+     */
+    explicit BellmanFordSP(const EdgeWeightedDigraph& G);
+    /**
+     * Computes a shortest paths tree from {@code s} to every other vertex in
+     * the frozen digraph {@code G}, relaxing straight over its edge arrays.
+     * @param G the digraph in compressed sparse row form
+     * @param s the source vertex
+     * @throws IllegalArgumentException unless {@code 0 <= s < V}
+     */
+    BellmanFordSP(const CsrDigraph& G, int s);
+    /**
+     * Collects every negative cycle of the frozen digraph {@code G} from a virtual super-source.
+     * @param G the digraph in compressed sparse row form
+     */
+    explicit BellmanFordSP(const CsrDigraph& G);
     /**
      * Is there a negative cycle reachable from the source vertex {@code s}?
      * @return {@code true} if there is a negative cycle reachable from the
@@ -58,6 +81,12 @@ public:
      *    as an iterable of edges, and {@code null} if there is no such cycle
      */
     std::stack<DirectedEdge *> negativeCycle() const { return _cycle; }
+    /**
+     * Returns every negative cycle found by the search, the first one being
+     * the cycle returned by {@code negativeCycle()}.
+     * @return the negative cycles as iterables of edges, empty if there is no such cycle
+     */
+    const std::vector<std::stack<DirectedEdge *>>& negativeCycles() const { return _cycles; }
     /**
      * Returns the length of a shortest path from the source vertex {@code s} to vertex {@code v}.
      * @param  v the destination vertex
@@ -91,8 +120,13 @@ public:
     std::vector<DirectedEdge *> pathTo(int v) const;
 
 private:
+    // run the queue-based Bellman-Ford algorithm from the source (or super-source)
+    template<typename Digraph>
+    void search(const Digraph& G);
     // relax vertex v and put other endpoints on queue if changed
     void relax(const EdgeWeightedDigraph& G, int v);
+    // same as above, reading the head vertices and weights from the CSR arrays
+    void relax(const CsrDigraph& G, int v);
     // by finding a cycle in predecessor graph
     void findNegativeCycle();
     // check optimality conditions: either
@@ -100,7 +134,8 @@ private:
     //     or
     // (ii)  for all edges e = v->w:            distTo[w] <= distTo[v] + e.weight()
     // (ii') for all edges e = v->w on the SPT: distTo[w] == distTo[v] + e.weight()
-    bool check(const EdgeWeightedDigraph& G, int s);
+    template<typename Digraph>
+    bool check(const Digraph& G, int s);
     // throw an IllegalArgumentException unless {@code 0 <= v < V}
     void validateVertex(int v) const;
 
@@ -108,9 +143,14 @@ private:
     std::vector<double> _distTo;               // distTo[v] = distance  of shortest s->v path
     std::vector<DirectedEdge *> _edgeTo;         // edgeTo[v] = last edge on shortest s->v path
     std::vector<bool> _onQueue;             // onQueue[v] = is v currently on the queue?
+    std::vector<bool> _blocked;             // blocked[v] = is v on an already reported cycle?
+    std::vector<uint64_t> _stamp;           // stamp[v] = last walk of the predecessor graph through v
+    uint64_t _walk = 0;                     // number of walks of the predecessor graph so far
     std::queue<int> _queue;          // queue of vertices to relax
-    int _cost;                      // number of calls to relax()
+    int _cost = 0;                  // number of calls to relax()
+    int _source = -1;               // source vertex, -1 for the virtual super-source
     std::stack<DirectedEdge *> _cycle;  // negative cycle (or null if no such cycle)
+    std::vector<std::stack<DirectedEdge *>> _cycles;  // all negative cycles found
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 csr_digraph.cc -std=c++17
+ *  Dependencies: edge_weighted_digraph.h directed_edge.h
+ *
+ *  A frozen edge-weighted digraph in compressed sparse row form.
+ *
+ ******************************************************************************/
+
+#include "csr_digraph.h"
+
+#include <stdexcept>
+
+#include "directed_edge.h"
+
+using std::string;
+
+/**
+ * Freezes the edge-weighted digraph {@code G} into compressed sparse row form.
+ *
+ * @param  G the edge-weighted digraph
+ */
+CsrDigraph::CsrDigraph(const EdgeWeightedDigraph &G) : VV(G.V()), EE(G.E()) {
+    _offsets.resize(VV + 1);
+    _to.reserve(EE);
+    _weight.reserve(EE);
+    _edges.reserve(EE);
+
+    for (int v = 0; v < VV; v++) {
+        _offsets[v] = _to.size();
+        for (DirectedEdge *e : G.adj(v)) {
+            _to.push_back(e->to());
+            _weight.push_back(e->weight());
+            _edges.push_back(e);
+        }
+    }
+    _offsets[VV] = _to.size();
+}
+
+// throw an IllegalArgumentException unless {@code 0 <= v < V}
+void CsrDigraph::validateVertex(int v) const {
+    if (v < 0 || v >= VV)
+        throw std::invalid_argument("vertex " + std::to_string(v) +
+                                    " is not between 0 and " + std::to_string(VV - 1));
+}
+
+/**
+ * Returns the directed edges incident from vertex {@code v}.
+ *
+ * @param  v the vertex
+ * @return the directed edges incident from vertex {@code v} as an Iterable
+ * @throws IllegalArgumentException unless {@code 0 <= v < V}
+ */
+CsrDigraph::EdgeRange CsrDigraph::adj(int v) const {
+    validateVertex(v);
+    return {_edges.data() + _offsets[v], _edges.data() + _offsets[v + 1]};
+}
+
+/**
+ * Returns the number of directed edges incident from vertex {@code v}.
+ *
+ * @param  v the vertex
+ * @return the outdegree of vertex {@code v}
+ * @throws IllegalArgumentException unless {@code 0 <= v < V}
+ */
+int CsrDigraph::outdegree(int v) const {
+    validateVertex(v);
+    return _offsets[v + 1] - _offsets[v];
+}
+
+/**
+ * Returns a string representation of this digraph.
+ *
+ * @return the number of vertices <em>V</em>, followed by the number of edges <em>E</em>,
+ *         followed by the <em>V</em> rows of edges
+ */
+string CsrDigraph::toString() const {
+    string s = "Vertices: " + std::to_string(VV) + " Edges: " + std::to_string(EE) + "\n";
+    for (int v = 0; v < VV; v++) {
+        s += std::to_string(v) + ": ";
+        for (int i = _offsets[v]; i < _offsets[v + 1]; i++)
+            s += std::to_string(v) + "->" + std::to_string(_to[i]) + " " + std::to_string(_weight[i]) + "  ";
+        s += "\n";
+    }
+    return s;
+}
@@ -0,0 +1,142 @@
+/**
+ *  The {@code CsrDigraph} class represents a frozen edge-weighted digraph
+ *  stored in compressed sparse row form.
+ *  The edges leaving vertex <em>v</em> occupy the slots
+ *  {@code offsets[v]} to {@code offsets[v+1] - 1} of the structure-of-arrays
+ *  {@code to[]} and {@code weight[]}, so that a relaxation loop walks
+ *  two contiguous arrays instead of chasing one pointer per edge.
+ *  The {@link DirectedEdge} behind every slot, with its asset metadata,
+ *  is kept in a side table and is only needed once a path or a cycle is reported.
+ *  <p>
+ *  The digraph is built in time proportional to <em>V</em> + <em>E</em>
+ *  from an {@link EdgeWeightedDigraph}. Its structure cannot be modified
+ *  afterwards, but the weight of a slot can be patched in place.
+ *  Edges keep the order of the adjacency lists they come from.
+ */
+
+#ifndef CSR_DIGRAPH_H
+#define CSR_DIGRAPH_H
+
+#include <string>
+#include <vector>
+
+#include "edge_weighted_digraph.h"
+
+class DirectedEdge;
+
+class CsrDigraph {
+public:
+    /**
+     * A contiguous slice of the edge side table, so that the digraph can be
+     * iterated with {@code for (DirectedEdge* e : G.adj(v))} like an {@link EdgeWeightedDigraph}.
+     */
+    struct EdgeRange {
+        DirectedEdge *const *first;
+        DirectedEdge *const *last;
+
+        [[nodiscard]] DirectedEdge *const *begin() const { return first; }
+
+        [[nodiscard]] DirectedEdge *const *end() const { return last; }
+
+        [[nodiscard]] size_t size() const { return last - first; }
+    };
+
+    /**
+     * Freezes the edge-weighted digraph {@code G} into compressed sparse row form.
+     *
+     * @param  G the edge-weighted digraph
+     */
+    explicit CsrDigraph(const EdgeWeightedDigraph &G);
+
+    /**
+     * Returns the number of vertices in this digraph.
+     *
+     * @return the number of vertices in this digraph
+     */
+    [[nodiscard]] int V() const { return VV; }
+
+    /**
+     * Returns the number of edges in this digraph.
+     *
+     * @return the number of edges in this digraph
+     */
+    [[nodiscard]] int E() const { return EE; }
+
+    /**
+     * Returns the row offsets: the edges incident from {@code v} are the slots
+     * {@code offsets()[v]} to {@code offsets()[v+1] - 1}. The array has <em>V</em> + 1 entries.
+     *
+     * @return the row offsets
+     */
+    [[nodiscard]] const int *offsets() const { return _offsets.data(); }
+
+    /**
+     * Returns the head vertex of every edge slot.
+     *
+     * @return the head vertices, indexed by edge slot
+     */
+    [[nodiscard]] const int *to() const { return _to.data(); }
+
+    /**
+     * Returns the weight of every edge slot.
+     *
+     * @return the edge weights, indexed by edge slot
+     */
+    [[nodiscard]] const double *weight() const { return _weight.data(); }
+
+    /**
+     * Returns the directed edge stored in slot {@code i}, with its asset metadata.
+     *
+     * @param  i the edge slot
+     * @return the directed edge of slot {@code i}
+     */
+    [[nodiscard]] DirectedEdge *edge(int i) const { return _edges[i]; }
+
+    /**
+     * Reprices edge slot {@code i}. The {@link DirectedEdge} of the slot is left untouched.
+     *
+     * @param  i the edge slot
+     * @param  weight the new weight of the slot
+     */
+    void setWeight(int i, double weight) { _weight[i] = weight; }
+
+    /**
+     * Returns the directed edges incident from vertex {@code v}.
+     *
+     * @param  v the vertex
+     * @return the directed edges incident from vertex {@code v} as an Iterable
+     * @throws IllegalArgumentException unless {@code 0 <= v < V}
+     */
+    [[nodiscard]] EdgeRange adj(int v) const;
+
+    /**
+     * Returns the number of directed edges incident from vertex {@code v}.
+     *
+     * @param  v the vertex
+     * @return the outdegree of vertex {@code v}
+     * @throws IllegalArgumentException unless {@code 0 <= v < V}
+     */
+    [[nodiscard]] int outdegree(int v) const;
+
+    /**
+     * Returns a string representation of this digraph.
+     *
+     * @return the number of vertices <em>V</em>, followed by the number of edges <em>E</em>,
+     *         followed by the <em>V</em> rows of edges
+     */
+    [[nodiscard]] std::string toString() const;
+
+private:
+    // throw an IllegalArgumentException unless {@code 0 <= v < V}
+    void validateVertex(int v) const;
+
+private:
+    int VV;                              // number of vertices in this digraph
+    int EE;                              // number of edges in this digraph
+    std::vector<int> _offsets;           // offsets[v] = first edge slot of vertex v
+    std::vector<int> _to;                // to[i] = head vertex of edge slot i
+    std::vector<double> _weight;         // weight[i] = weight of edge slot i
+    std::vector<DirectedEdge *> _edges;  // edges[i] = edge (and assets) of slot i
+};
+
+#endif
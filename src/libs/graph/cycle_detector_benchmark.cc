@@ -0,0 +1,97 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 directed_edge.cc -std=c++17
+ *                clang++ -c -O2 edge_weighted_digraph.cc -std=c++17
+ *                clang++ -c -O2 csr_digraph.cc -std=c++17
+ *                clang++ -c -O2 bellman_ford_sp.cc -std=c++17
+ *                clang++ -c -O2 tarjan_cycle_detector.cc -std=c++17
+ *                clang++ -O2 -DDebug cycle_detector_benchmark.cc tarjan_cycle_detector.o bellman_ford_sp.o csr_digraph.o edge_weighted_digraph.o directed_edge.o -std=c++17 -o cycle_detector_benchmark
+ *  Execution:    ./cycle_detector_benchmark graph.txt [graph.txt ...]
+ *                ./cycle_detector_benchmark --synthetic V P [seed] [noise]
+ *  Dependencies: bellman_ford_sp.h tarjan_cycle_detector.h csr_digraph.h
+ *                edge_weighted_digraph.h directed_edge.h synthetic_market.h
+ *
+ *  Compares the super-source Bellman-Ford-Moore search with Tarjan's subtree
+ *  disassembly on recorded DEX graphs, as written by the streaming cycle when
+ *  GRAPH_RECORD_DIR is set, or on a synthetic DEX graph of V tokens and P pools
+ *  priced around random mid prices with a 0.3% fee and some noise (0.2% by default).
+ *  Every search is repeated and the best time is kept.
+ *
+ *  % cycle_detector_benchmark --synthetic 2000 8000
+ *  synthetic 2000 8000: V 2000 E 15990
+ *    bellman-ford-moore :   ... ms  ... cycles
+ *    tarjan             :   ... ms  ... cycles  ... scans
+ *
+ ******************************************************************************/
+
+#ifdef Debug
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "bellman_ford_sp.h"
+#include "tarjan_cycle_detector.h"
+#include "csr_digraph.h"
+#include "directed_edge.h"
+#include "edge_weighted_digraph.h"
+#include "synthetic_market.h"
+
+// best of a few runs of search(), in milliseconds
+template<typename Search>
+static double bestOf(int runs, Search search) {
+    double best = 1e300;
+    for (int r = 0; r < runs; r++) {
+        auto start = std::chrono::steady_clock::now();
+        search();
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+static void compare(const std::string &name, const EdgeWeightedDigraph &G) {
+    CsrDigraph csr(G);
+    printf("%s: V %d E %d\n", name.c_str(), csr.V(), csr.E());
+
+    size_t cycles = 0;
+    double ms = bestOf(5, [&]() {
+        BellmanFordSP spt(csr);
+        cycles = spt.negativeCycles().size();
+    });
+    printf("  bellman-ford-moore : %8.2f ms  %zu cycles\n", ms, cycles);
+
+    long scans = 0;
+    ms = bestOf(5, [&]() {
+        TarjanCycleDetector detector(csr);
+        cycles = detector.negativeCycles().size();
+        scans = detector.scans();
+    });
+    printf("  tarjan             : %8.2f ms  %zu cycles  %ld scans\n", ms, cycles, scans);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 3 && strcmp(argv[1], "--synthetic") == 0) {
+        int V = std::stoi(argv[2]);
+        int P = std::stoi(argv[3]);
+        unsigned seed = argc > 4 ? std::stoul(argv[4]) : 42;
+        double sigma = argc > 5 ? std::stod(argv[5]) : 0.002;
+
+        EdgeWeightedDigraph G(V);
+        for (const SyntheticPool &pool : syntheticMarket(V, P, seed, sigma)) {
+            addPool(G, pool.v, pool.w, pool.mid + pool.noise);
+        }
+        compare("synthetic " + std::string(argv[2]) + " " + argv[3], G);
+        return 0;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        std::fstream in(argv[i]);
+        EdgeWeightedDigraph G(in);
+        compare(argv[i], G);
+    }
+    return 0;
+}
+#endif
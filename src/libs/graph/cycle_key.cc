@@ -0,0 +1,46 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 directed_edge.cc -std=c++17
+ *                clang++ -c -O2 cycle_key.cc -std=c++17
+ *  Dependencies: directed_edge.h
+ *
+ *  Rotation-invariant 64-bit key of a cycle.
+ *
+ ******************************************************************************/
+
+#include "cycle_key.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "directed_edge.h"
+
+using std::stack;
+using std::vector;
+
+namespace {
+    // splitmix64 finalizer, every input bit moves every output bit
+    uint64_t mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+}
+
+/**
+ * Returns the key of a cycle, the same for all its rotations.
+ * @param cycle the cycle, from its first edge on top
+ * @return the 64-bit key of the cycle
+ */
+uint64_t cycleKey(const stack<DirectedEdge *> &cycle) {
+    vector<uint64_t> ids;
+    ids.reserve(cycle.size());
+    for (stack<DirectedEdge *> edges(cycle); !edges.empty(); edges.pop())
+        ids.emplace_back(uint64_t(edges.top()->pool()) * 2 + (edges.top()->zero_for_one() ? 1 : 0));
+
+    size_t first = std::min_element(ids.begin(), ids.end()) - ids.begin();
+    uint64_t key = mix(ids.size());
+    for (size_t k = 0; k < ids.size(); k++)
+        key = mix(key ^ ids[(first + k) % ids.size()]);
+    return key;
+}
@@ -0,0 +1,24 @@
+/**
+ *  The {@code cycleKey} function identifies a cycle by the pools it swaps through
+ *  and their directions, up to rotation: the same route found from two different
+ *  vertices gets the same key. The edge ids, {@code 2 * pool + zero_for_one}, are
+ *  rotated to start at the smallest one and hashed to 64 bits, without formatting
+ *  anything, so that duplicates are dropped before a cycle is ever printed.
+ */
+
+#ifndef CYCLE_KEY_H
+#define CYCLE_KEY_H
+
+#include <cstdint>
+#include <stack>
+
+class DirectedEdge;
+
+/**
+ * Returns the key of a cycle, the same for all its rotations.
+ * @param cycle the cycle, from its first edge on top
+ * @return the 64-bit key of the cycle
+ */
+uint64_t cycleKey(const std::stack<DirectedEdge *> &cycle);
+
+#endif
@@ -3,7 +3,7 @@
  *  Execution:    ./directed_edge
  *  Dependencies:
  *
- *  Immutable weighted directed edge.
+ *  Weighted directed edge, repriced in place as its pool moves.
  *
  ******************************************************************************/
 
@@ -39,12 +39,14 @@ using std::string;
  * @param v the tail vertex
  * @param w the head vertex
  * @param weight the weight of the directed edge
+ * @param pool the id of the pool the edge swaps through
+ * @param zero_for_one {@code true} if the edge sells token0 of the pool for token1
  * @throws IllegalArgumentException if either {@code v} or {@code w}
  *    is a negative integer
  * @throws IllegalArgumentException if {@code weight} is {@code NaN}
  */
-DirectedEdge::DirectedEdge(int v, int w, double weight, Asset &a_from, Asset &a_to) :
-        _v(v), _w(w), _weight(weight), _asset_from(a_from), _asset_to(a_to) {
+DirectedEdge::DirectedEdge(int v, int w, double weight, uint32_t pool, bool zero_for_one) :
+        _v(v), _w(w), _weight(weight), _pool(pool), _zero_for_one(zero_for_one) {
     if (v < 0)
         throw std::invalid_argument("Vertex names must be nonnegative integers");
     if (w < 0)
@@ -3,7 +3,7 @@
  *  Execution:    ./directed_edge
  *  Dependencies:
  *
- *  Immutable weighted directed edge.
+ *  Weighted directed edge, repriced in place as its pool moves.
  *
  ******************************************************************************/
 
@@ -14,6 +14,10 @@
  *  provides methods for accessing the two endpoints of the directed edge and
  *  the weight.
  *  <p>
+ *  An edge is a swap through a pool: it only records the id of the pool in
+ *  its {@link AssetTable} and the direction of the swap, the assets on
+ *  both ends being looked up in the table.
+ *  <p>
  *  For additional documentation, see <a href="https://algs4.cs.princeton.edu/44sp">Section 4.4</a> of
  *  <i>Algorithms, 4th Edition</i> by Robert Sedgewick and Kevin Wayne.
  *
@@ -24,8 +28,8 @@
 #ifndef DIRECTED_EDGE_H
 #define DIRECTED_EDGE_H
 
+#include <cstdint>
 #include <string>
-#include "asset.h"
 
 class DirectedEdge {
 public:
@@ -35,11 +39,13 @@ public:
      * @param v the tail vertex
      * @param w the head vertex
      * @param weight the weight of the directed edge
+     * @param pool the id of the pool the edge swaps through
+     * @param zero_for_one {@code true} if the edge sells token0 of the pool for token1
      * @throws IllegalArgumentException if either {@code v} or {@code w}
      *    is a negative integer
      * @throws IllegalArgumentException if {@code weight} is {@code NaN}
      */
-    DirectedEdge(int v, int w, double weight, Asset &a_from, Asset &a_to);
+    DirectedEdge(int v, int w, double weight, uint32_t pool = 0, bool zero_for_one = true);
 
     /**
      * Returns the tail vertex of the directed edge.
@@ -60,16 +66,22 @@ public:
     double weight() const { return _weight; }
 
     /**
-     * Returns the from asset of the directed edge.
-     * @return the from asset of the directed edge.
+     * Reprices the directed edge, the endpoints and the pool staying the same.
+     * @param weight the new weight of the directed edge
+     */
+    void setWeight(double weight) { _weight = weight; }
+
+    /**
+     * Returns the id of the pool the directed edge swaps through.
+     * @return the pool id of the directed edge
      */
-    const Asset asset_from() const { return _asset_from; }
+    uint32_t pool() const { return _pool; }
 
     /**
-     * Returns the to asset of the directed edge.
-     * @return the to asset of the directed edge.
+     * Does the directed edge sell token0 of its pool for token1?
+     * @return {@code true} if the edge goes from token0 to token1 of its pool
      */
-    const Asset asset_to() const { return _asset_to; }
+    bool zero_for_one() const { return _zero_for_one; }
 
     /**
      * Returns a string representation of the directed edge.
@@ -81,8 +93,8 @@ private:
     int _v;
     int _w;
     double _weight;
-    Asset _asset_from;
-    Asset _asset_to;
+    uint32_t _pool;
+    bool _zero_for_one;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,41 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 edge_arena.cc -std=c++17
+ *  Dependencies: directed_edge.h
+ *
+ *  Bump allocator for the directed edges of a graph snapshot.
+ *
+ ******************************************************************************/
+
+#include "edge_arena.h"
+
+#include <stdexcept>
+
+/**
+ * Initializes an empty arena that grows {@code block_size} edges at a time.
+ *
+ * @param  block_size the number of edges per block
+ */
+EdgeArena::EdgeArena(size_t block_size) : _block_size(block_size) {
+    if (block_size == 0)
+        throw std::invalid_argument("Arena block size must be positive");
+}
+
+EdgeArena::~EdgeArena() {
+    reset();
+}
+
+/**
+ * Releases every edge of the arena, keeping its blocks for the next snapshot.
+ * Constant time when edges are trivially destructible.
+ */
+void EdgeArena::reset() {
+    if constexpr (!std::is_trivially_destructible_v<DirectedEdge>) {
+        for (size_t b = 0; b < _blocks.size() && b <= _block; b++) {
+            size_t used = b < _block ? _block_size : _used;
+            for (size_t i = 0; i < used; i++)
+                std::launder(reinterpret_cast<DirectedEdge *>(&_blocks[b][i]))->~DirectedEdge();
+        }
+    }
+    _block = 0;
+    _used = 0;
+}
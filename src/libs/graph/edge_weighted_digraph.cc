@@ -43,6 +43,7 @@
 #include <fstream>
 
 #include "directed_edge.h"
+#include "asset_table.h"
 
 using std::vector;
 using std::string;
@@ -79,8 +80,8 @@ EdgeWeightedDigraph::EdgeWeightedDigraph(int V, int E) : EdgeWeightedDigraph(V)
         int v = dis(_gen);
         int w = dis(_gen);
         double weight = 0.01 * dis100(_gen);
-        //     DirectedEdge *e = new DirectedEdge(v, w, weight);
-        //     addEdge(e);
+        DirectedEdge *e = new DirectedEdge(v, w, weight);
+        addEdge(e);
     }
 }
 
@@ -123,7 +124,7 @@ EdgeWeightedDigraph::EdgeWeightedDigraph(fstream &in) : _gen(_rd()) {
 
         str = end;
         double weight = std::strtod(str, &end);
-        //    addEdge(new DirectedEdge(v, w, weight));
+        addEdge(new DirectedEdge(v, w, weight));
     }
 }
 
@@ -158,8 +159,6 @@ void EdgeWeightedDigraph::validateVertex(int v) const {
 void EdgeWeightedDigraph::addEdge(DirectedEdge *e) {
     int v = e->from();
     int w = e->to();
-    Asset a_from = e->asset_from();
-    Asset a_to = e->asset_to();
     validateVertex(v);
     validateVertex(w);
     _adj[v].push_back(e);
@@ -167,6 +166,17 @@ void EdgeWeightedDigraph::addEdge(DirectedEdge *e) {
     EE++;
 }
 
+/**
+ * Adds an isolated vertex to this edge-weighted digraph.
+ *
+ * @return the new vertex, numbered <em>V</em> - 1
+ */
+int EdgeWeightedDigraph::addVertex() {
+    _adj.emplace_back();
+    _indegree.push_back(0);
+    return VV++;
+}
+
 /**
  * Returns the directed edges incident from vertex {@code v}.
  *
@@ -238,19 +248,20 @@ string EdgeWeightedDigraph::toString() const {
 }
 
 /**
- * Returns a string representation of this edge-weighted digraph in Graphviz format.
+ * Returns a Graphviz representation of this edge-weighted digraph,
+ * labelling vertices and edges with the assets and pools of {@code assets}.
  *
- * @return the number of vertices <em>V</em>, followed by the number of edges <em>E</em>,
- *         followed by the <em>V</em> adjacency lists of edges
+ * @param  assets the table the edges of this digraph refer to
+ * @return the digraph in Graphviz dot format
  */
-
-string EdgeWeightedDigraph::getGraphviz() const {
+string EdgeWeightedDigraph::getGraphviz(const AssetTable &assets) const {
     std::string s;
     s.append("digraph G {\n");
     s.append("\tnode [shape = circle];\n\n");
     for (int v = 0; v < VV; v++) {
+        if (_adj[v].empty()) continue;
         s.append("\t");
-        s.append("\"" + _adj[0][0]->asset_from().symbol + "\"");
+        s.append("\"" + assets.from(*_adj[v][0]).symbol + "\"");
         if (v == 0) {
             s.append(" [style=filled fillcolor=orange fontcolor=black];\n");
         } else {
@@ -258,11 +269,12 @@ string EdgeWeightedDigraph::getGraphviz() const {
         }
         s.append("\t");
         for (DirectedEdge *e : _adj[v]) {
-            s.append("\"" + e->asset_from().symbol + "\"");
+            const Pool &pool = assets.pool(*e);
+            s.append("\"" + assets.from(*e).symbol + "\"");
             s.append(" -> ");
-            s.append("\"" + e->asset_to().symbol + "\"");
-            s.append("[label = \"" + std::to_string(e->weight()) + "_" + e->asset_from().protocol + "_" +
-                     e->asset_from().poolID + "\"];\n");
+            s.append("\"" + assets.to(*e).symbol + "\"");
+            s.append("[label = \"" + std::to_string(e->weight()) + "_" + pool.protocol + "_" +
+                     pool.poolID + "\"];\n");
             s.append("\t");
         }
         s += "\n";
@@ -6,9 +6,9 @@
 #include <fstream>
 #include <string>
 #include <unordered_map>
-#include "asset.h"
 
 class DirectedEdge;
+class AssetTable;
 
 class EdgeWeightedDigraph {
 public:
@@ -67,6 +67,12 @@ public:
      *         and {@code V-1}
      */
     void addEdge(DirectedEdge* e);
+    /**
+     * Adds an isolated vertex to this edge-weighted digraph.
+     *
+     * @return the new vertex, numbered <em>V</em> - 1
+     */
+    int addVertex();
     /**
      * Returns the directed edges incident from vertex {@code v}.
      *
@@ -109,7 +115,14 @@ public:
      */
     [[nodiscard]] std::string toString() const;
 
-    [[nodiscard]] std::string getGraphviz() const;
+    /**
+     * Returns a Graphviz representation of this edge-weighted digraph,
+     * labelling vertices and edges with the assets and pools of {@code assets}.
+     *
+     * @param  assets the table the edges of this digraph refer to
+     * @return the digraph in Graphviz dot format
+     */
+    [[nodiscard]] std::string getGraphviz(const AssetTable &assets) const;
 
 private:
     // throw an IllegalArgumentException unless {@code 0 <= v < V}
@@ -53,6 +53,21 @@ using std::stack;
  * @param G the edge-weighted digraph
  */
 EdgeWeightedDirectedCycle::EdgeWeightedDirectedCycle(const EdgeWeightedDigraph& G) {
+    search(G);
+}
+
+/**
+ * Determines whether the frozen digraph {@code G} has a directed cycle and,
+ * if so, finds such a cycle.
+ * @param G the digraph in compressed sparse row form
+ */
+EdgeWeightedDirectedCycle::EdgeWeightedDirectedCycle(const CsrDigraph& G) {
+    search(G);
+}
+
+// run depth-first search from every unmarked vertex
+template<typename Digraph>
+void EdgeWeightedDirectedCycle::search(const Digraph& G) {
     _marked.resize(G.V());
     _on_stack.resize(G.V());
     _edge_to.resize(G.V());
@@ -64,7 +79,8 @@ EdgeWeightedDirectedCycle::EdgeWeightedDirectedCycle(const EdgeWeightedDigraph&
 }
 
 // check that algorithm computes either the topological order or finds a directed cycle
-void EdgeWeightedDirectedCycle::dfs(const EdgeWeightedDigraph& G, int v) {
+template<typename Digraph>
+void EdgeWeightedDirectedCycle::dfs(const Digraph& G, int v) {
     _on_stack[v] = true;
     _marked[v] = true;
     for (DirectedEdge* e : G.adj(v)) {
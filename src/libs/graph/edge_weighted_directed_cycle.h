@@ -31,6 +31,7 @@
 #include <stack>
 
 #include "edge_weighted_digraph.h"
+#include "csr_digraph.h"
 
 class EdgeWeightedDirectedCycle {
 public:
@@ -40,6 +41,12 @@ public:
      * @param G the edge-weighted digraph
      */
     EdgeWeightedDirectedCycle(const EdgeWeightedDigraph& G);
+    /**
+     * Determines whether the frozen digraph {@code G} has a directed cycle and,
+     * if so, finds such a cycle.
+     * @param G the digraph in compressed sparse row form
+     */
+    EdgeWeightedDirectedCycle(const CsrDigraph& G);
     /**
      * Does the edge-weighted digraph have a directed cycle?
      * @return {@code true} if the edge-weighted digraph has a directed cycle,
@@ -56,8 +63,12 @@ public:
 
 
 private:
+    // run depth-first search from every unmarked vertex
+    template<typename Digraph>
+    void search(const Digraph& G);
     // check that algorithm computes either the topological order or finds a directed cycle
-    void dfs(const EdgeWeightedDigraph& G, int v);
+    template<typename Digraph>
+    void dfs(const Digraph& G, int v);
     // certify that digraph is either acyclic or has a directed cycle
     bool check() const;
 private:
@@ -0,0 +1,137 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 directed_edge.cc -std=c++17
+ *                clang++ -c -O2 edge_weighted_digraph.cc -std=c++17
+ *                clang++ -c -O2 csr_digraph.cc -std=c++17
+ *                clang++ -c -O2 hop_bounded_cycles.cc -std=c++17
+ *  Dependencies: csr_digraph.h directed_edge.h
+ *
+ *  Enumerates every negative cycle of at most Hops edges, instantiated
+ *  for routes of 2, 3 and 4 swaps.
+ *
+ ******************************************************************************/
+
+#include "hop_bounded_cycles.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+#include "directed_edge.h"
+
+using std::stack;
+using std::vector;
+
+/**
+ * Enumerates every negative cycle of at most {@code Hops} edges of {@code G}.
+ * @param G the digraph in compressed sparse row form
+ */
+template<int Hops>
+HopBoundedCycles<Hops>::HopBoundedCycles(const CsrDigraph &G) : HopBoundedCycles(G, 0, G.V()) {}
+
+/**
+ * Enumerates the negative cycles of at most {@code Hops} edges of {@code G}
+ * whose smallest vertex is between {@code first} and {@code last - 1}.
+ * @param G the digraph in compressed sparse row form
+ * @param first the first vertex of the range
+ * @param last one past the last vertex of the range
+ */
+template<int Hops>
+HopBoundedCycles<Hops>::HopBoundedCycles(const CsrDigraph &G, int first, int last) : _G(G) {
+    for (int i = 0; i < G.E(); i++)
+        _minWeight = std::min(_minWeight, G.weight()[i]);
+
+    twoHops(first, last);
+    if constexpr (Hops > 2) {
+        for (_source = first; _source < last; _source++)
+            extend<0>(_source, 0.0);
+    }
+}
+
+// pair the edges of every token pair with a smallest vertex in the range
+template<int Hops>
+void HopBoundedCycles<Hops>::twoHops(int first, int last) {
+    const int *offsets = _G.offsets();
+    const int *to = _G.to();
+    const double *weight = _G.weight();
+
+    // bucket the edges on their unordered pair of endpoints
+    std::unordered_map<uint64_t, vector<int>> pairs;
+    for (int v = 0; v < _G.V(); v++) {
+        for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+            int w = to[i];
+            int lo = std::min(v, w);
+            if (v == w || lo < first || lo >= last || std::isinf(weight[i])) continue;
+            uint64_t key = (uint64_t(lo) << 32) | uint32_t(std::max(v, w));
+            pairs[key].push_back(i);
+        }
+    }
+
+    for (auto const &[key, slots] : pairs) {
+        int lo = int(key >> 32);
+        for (int i : slots) {
+            if (_G.edge(i)->from() != lo) continue;   // lo->hi edges, paired with the hi->lo ones
+            for (int j : slots) {
+                if (_G.edge(j)->from() == lo) continue;
+                const DirectedEdge *e = _G.edge(i);
+                const DirectedEdge *f = _G.edge(j);
+                if (e->pool() == f->pool() && e->zero_for_one() != f->zero_for_one()) continue;
+                _paths++;
+                if (weight[i] + weight[j] < 0.0) {
+                    _path[0] = i;
+                    _path[1] = j;
+                    record(2);
+                }
+            }
+        }
+    }
+}
+
+// extend the path of Depth edges ending at v, of total weight weight
+template<int Hops>
+template<int Depth>
+void HopBoundedCycles<Hops>::extend(int v, double weight) {
+    const int *offsets = _G.offsets();
+    const int *to = _G.to();
+    const double *weights = _G.weight();
+    for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+        int w = to[i];
+        double total = weight + weights[i];
+        if (std::isinf(weights[i])) continue;
+
+        if (w == _source) {
+            // cycles of two edges are paired up by twoHops()
+            if (Depth + 1 >= 3 && total < 0.0) {
+                _path[Depth] = i;
+                record(Depth + 1);
+            }
+            continue;
+        }
+
+        if constexpr (Depth + 1 < Hops) {
+            if (w < _source) continue;     // the cycle is reported from its smallest vertex
+            bool visited = false;
+            for (int k = 0; k < Depth; k++) visited |= to[_path[k]] == w;
+            if (visited) continue;
+            // even the most negative edge on every remaining hop would not close a negative cycle
+            if (total + (Hops - Depth - 1) * _minWeight >= 0.0) continue;
+
+            _paths++;
+            _path[Depth] = i;
+            extend<Depth + 1>(w, total);
+        }
+    }
+}
+
+// record the path of length edges as a cycle
+template<int Hops>
+void HopBoundedCycles<Hops>::record(int length) {
+    stack<DirectedEdge *> cycle;
+    for (int k = length - 1; k >= 0; k--)
+        cycle.push(_G.edge(_path[k]));
+    _cycles.emplace_back(cycle);
+}
+
+template class HopBoundedCycles<2>;
+template class HopBoundedCycles<3>;
+template class HopBoundedCycles<4>;
@@ -0,0 +1,81 @@
+/**
+ *  The {@code HopBoundedCycles} class enumerates every negative cycle of at most
+ *  {@code Hops} edges of a {@link CsrDigraph}, where {@link BellmanFordSP} returns
+ *  one arbitrary cycle of any length per source. Routes longer than a few swaps
+ *  never pay for their gas, and the short ones are exactly the ones we want all of.
+ *  <p>
+ *  Cycles of two edges, a token pair traded back and forth across two pools, are
+ *  found without any search: the edges are bucketed on their unordered pair of
+ *  endpoints, and every bucket pairs its edges one way with its edges the other way.
+ *  The two edges of a single pool are not paired with each other.
+ *  <p>
+ *  Longer cycles are enumerated by a depth-first search from every vertex
+ *  <em>s</em> that only visits vertices greater than <em>s</em>, so that every
+ *  cycle is reported once, from its smallest vertex. The search is unrolled at
+ *  compile time, one level per hop, and a path is abandoned as soon as even the
+ *  most negative edge of the digraph on every remaining hop could not bring it
+ *  below zero. Edges of infinite weight are skipped.
+ *  <p>
+ *  The enumeration can be restricted to the cycles whose smallest vertex lies in a
+ *  range, so that disjoint ranges can be searched in parallel.
+ */
+
+#ifndef HOP_BOUNDED_CYCLES_H
+#define HOP_BOUNDED_CYCLES_H
+
+#include <array>
+#include <stack>
+#include <vector>
+
+#include "csr_digraph.h"
+
+class DirectedEdge;
+
+template<int Hops>
+class HopBoundedCycles {
+    static_assert(Hops >= 2, "a cycle has at least two hops");
+
+public:
+    /**
+     * Enumerates every negative cycle of at most {@code Hops} edges of {@code G}.
+     * @param G the digraph in compressed sparse row form
+     */
+    explicit HopBoundedCycles(const CsrDigraph &G);
+    /**
+     * Enumerates the negative cycles of at most {@code Hops} edges of {@code G}
+     * whose smallest vertex is between {@code first} and {@code last - 1}.
+     * @param G the digraph in compressed sparse row form
+     * @param first the first vertex of the range
+     * @param last one past the last vertex of the range
+     */
+    HopBoundedCycles(const CsrDigraph &G, int first, int last);
+    /**
+     * Returns the negative cycles found, each from its first edge on top.
+     * @return the negative cycles as iterables of edges
+     */
+    const std::vector<std::stack<DirectedEdge *>> &cycles() const { return _cycles; }
+    /**
+     * Returns the number of paths extended by the search.
+     * @return the number of paths extended by the search
+     */
+    long paths() const { return _paths; }
+
+private:
+    // pair the edges of every token pair with a smallest vertex in the range
+    void twoHops(int first, int last);
+    // extend the path of Depth edges ending at v, of total weight weight
+    template<int Depth>
+    void extend(int v, double weight);
+    // record the path of length edges as a cycle
+    void record(int length);
+
+private:
+    const CsrDigraph &_G;
+    double _minWeight = 0.0;                // most negative edge weight, or 0
+    int _source = -1;                       // smallest vertex of the cycles searched
+    std::array<int, Hops> _path{};          // slots of the current path
+    long _paths = 0;                        // number of paths extended
+    std::vector<std::stack<DirectedEdge *>> _cycles;   // negative cycles found
+};
+
+#endif
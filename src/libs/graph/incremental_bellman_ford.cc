@@ -0,0 +1,251 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 directed_edge.cc -std=c++17
+ *                clang++ -c -O2 edge_weighted_digraph.cc -std=c++17
+ *                clang++ -c -O2 csr_digraph.cc -std=c++17
+ *                clang++ -c -O2 incremental_bellman_ford.cc -std=c++17
+ *  Dependencies: csr_digraph.h directed_edge.h
+ *
+ *  Super-source Bellman-Ford kept up to date across weight changes,
+ *  reporting the negative cycles each batch of changes creates.
+ *
+ ******************************************************************************/
+
+#include "incremental_bellman_ford.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "directed_edge.h"
+
+using std::stack;
+using std::vector;
+
+/**
+ * Computes the shortest paths from the super-source in {@code G}
+ * and collects its negative cycles.
+ * @param G the digraph in compressed sparse row form
+ */
+IncrementalBellmanFord::IncrementalBellmanFord(const CsrDigraph &G) {
+    reset(G);
+}
+
+/**
+ * Forgets every distance and runs a full search on {@code G},
+ * after its structure changed.
+ * @param G the digraph in compressed sparse row form
+ */
+void IncrementalBellmanFord::reset(const CsrDigraph &G) {
+    _G = &G;
+    int V = G.V();
+    int E = G.E();
+    const int *offsets = G.offsets();
+    const int *to = G.to();
+
+    _from.resize(E);
+    for (int v = 0; v < V; v++)
+        for (int i = offsets[v]; i < offsets[v + 1]; i++)
+            _from[i] = v;
+
+    // reverse adjacency, counting sort of the slots on their head vertex
+    _inOffsets.assign(V + 1, 0);
+    for (int i = 0; i < E; i++) _inOffsets[to[i] + 1]++;
+    for (int v = 0; v < V; v++) _inOffsets[v + 1] += _inOffsets[v];
+    _inSlots.resize(E);
+    vector<int> next(_inOffsets.begin(), _inOffsets.end() - 1);
+    for (int i = 0; i < E; i++) _inSlots[next[to[i]]++] = i;
+
+    _weight.assign(G.weight(), G.weight() + E);
+    _distTo.resize(V);
+    _edgeTo.resize(V);
+    _onQueue.assign(V, false);
+    _blocked.resize(V);
+    _stamp.assign(V, 0);
+    _walk = 0;
+    full();
+}
+
+/**
+ * Brings the shortest paths up to date after the weights of some edge slots
+ * were patched in the digraph, and returns the negative cycles the changes created.
+ * @param slots the edge slots whose weight changed since the last search
+ * @return the negative cycles found, as iterables of edges
+ */
+const vector<stack<DirectedEdge *>> &IncrementalBellmanFord::update(const vector<int> &slots) {
+    const double *weight = _G->weight();
+    if (_stale) {
+        for (int i : slots) _weight[i] = weight[i];
+        full();
+        return _cycles;
+    }
+
+    _cycles.clear();
+    _incremental = true;
+    _relaxations = 0;
+
+    // tree edges that got more expensive first, so that the frontiers requeued
+    // below see the reset distances
+    for (int i : slots) {
+        int w = _G->to()[i];
+        if (weight[i] > _weight[i] && _edgeTo[w] == i) invalidate(w);
+    }
+    for (int i : slots) {
+        if (weight[i] < _weight[i]) enqueue(_from[i]);
+        _weight[i] = weight[i];
+    }
+
+    search();
+    return _cycles;
+}
+
+// start over from the super-source
+void IncrementalBellmanFord::full() {
+    _cycles.clear();
+    _incremental = false;
+    _stale = false;
+    _relaxations = 0;
+    _queue = {};
+
+    // the super-source reaches every vertex through a zero-weight edge
+    for (int v = 0; v < _G->V(); v++) {
+        _distTo[v] = 0.0;
+        _edgeTo[v] = -1;
+        _blocked[v] = false;
+        _onQueue[v] = false;
+        enqueue(v);
+    }
+    search();
+}
+
+// run the queue-based Bellman-Ford algorithm until the queue drains
+void IncrementalBellmanFord::search() {
+    _cost = 0;
+    while (!_queue.empty()) {
+        int v = _queue.front();
+        _queue.pop();
+        _onQueue[v] = false;
+        if (!_blocked[v]) relax(v);
+    }
+}
+
+// relax the edges leaving v and put the other endpoints on queue if changed
+void IncrementalBellmanFord::relax(int v) {
+    const int *offsets = _G->offsets();
+    const int *to = _G->to();
+    const double *weight = _G->weight();
+    for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+        int w = to[i];
+        if (_blocked[w]) continue;       // already part of a reported cycle
+        _relaxations++;
+        if (_distTo[w] > _distTo[v] + weight[i]) {
+            _distTo[w] = _distTo[v] + weight[i];
+            _edgeTo[w] = i;
+            enqueue(w);
+        }
+        if (++_cost % _G->V() == 0) {
+            findNegativeCycles();
+            if (_blocked[v]) return;     // v has just been retired with its cycle
+        }
+    }
+}
+
+// put v on queue unless it is already there
+void IncrementalBellmanFord::enqueue(int v) {
+    if (_onQueue[v]) return;
+    _queue.push(v);
+    _onQueue[v] = true;
+}
+
+// hang the subtree of w back from the super-source and requeue its frontier:
+// the vertices of the subtree may now reach each other, or be reached from
+// their in-neighbours, more cheaply than through the super-source
+void IncrementalBellmanFord::invalidate(int w) {
+    const int *offsets = _G->offsets();
+    const int *to = _G->to();
+    uint64_t walk = ++_walk;
+
+    // the children of x are the heads of the slots leaving x that are their edgeTo
+    _subtree.clear();
+    _subtree.push_back(w);
+    _stamp[w] = walk;
+    for (size_t k = 0; k < _subtree.size(); k++) {
+        int x = _subtree[k];
+        for (int i = offsets[x]; i < offsets[x + 1]; i++) {
+            int y = to[i];
+            if (_edgeTo[y] == i && _stamp[y] != walk) {
+                _stamp[y] = walk;
+                _subtree.push_back(y);
+            }
+        }
+    }
+
+    for (int x : _subtree) {
+        _distTo[x] = 0.0;
+        _edgeTo[x] = -1;
+        enqueue(x);
+        for (int j = _inOffsets[x]; j < _inOffsets[x + 1]; j++) {
+            int u = _from[_inSlots[j]];
+            if (_stamp[u] != walk) enqueue(u);
+        }
+    }
+}
+
+// find the cycles of the predecessor graph, retiring their vertices
+void IncrementalBellmanFord::findNegativeCycles() {
+    const double *weight = _G->weight();
+    int V = _G->V();
+    uint64_t first = _walk + 1;    // walks of this check are numbered from here
+
+    for (int v = 0; v < V; v++) {
+        if (_blocked[v] || _stamp[v] >= first) continue;
+
+        // follow the predecessors until the super-source, a vertex seen by an
+        // earlier walk, or a vertex seen by this very walk: the latter closes a cycle
+        uint64_t walk = ++_walk;
+        int x = v;
+        while (x >= 0 && !_blocked[x] && _stamp[x] < first) {
+            _stamp[x] = walk;
+            x = _edgeTo[x] < 0 ? -1 : _from[_edgeTo[x]];
+        }
+        if (x < 0 || _blocked[x] || _stamp[x] != walk) continue;
+
+        // x is on the cycle, walking back from it pushes the edges so that
+        // the first edge leaving x ends up on top
+        stack<DirectedEdge *> cycle;
+        double total = 0.0;
+        int y = x;
+        do {
+            int i = _edgeTo[y];
+            cycle.push(_G->edge(i));
+            total += weight[i];
+            y = _from[i];
+        } while (y != x);
+
+        // the potential no longer holds around the retired vertices
+        _stale = true;
+        y = x;
+        do {
+            _blocked[y] = true;
+            y = _from[_edgeTo[y]];
+        } while (y != x);
+
+        if (total < 0.0) _cycles.emplace_back(cycle);
+    }
+}
+
+/**
+ * Returns the length of a shortest path from the super-source to vertex {@code v}.
+ * @param  v the destination vertex
+ * @return the length of a shortest path from the super-source to vertex {@code v}
+ * @throws IllegalArgumentException unless {@code 0 <= v < V}
+ */
+double IncrementalBellmanFord::distTo(int v) const {
+    validateVertex(v);
+    return _distTo[v];
+}
+
+// throw an IllegalArgumentException unless {@code 0 <= v < V}
+void IncrementalBellmanFord::validateVertex(int v) const {
+    int V = _distTo.size();
+    if (v < 0 || v >= V)
+        throw std::invalid_argument("vertex " + std::to_string(v) + " is not between 0 and " + std::to_string(V - 1));
+}
@@ -0,0 +1,122 @@
+/**
+ *  The {@code IncrementalBellmanFord} class keeps the shortest paths from a
+ *  virtual super-source, linked to every vertex by a zero-weight edge, up to
+ *  date while the weights of a frozen {@link CsrDigraph} are patched in place.
+ *  The distances are a feasible potential of the digraph: as long as it has no
+ *  negative cycle, any negative cycle created by a batch of weight changes must
+ *  go through one of the changed edges, so the search only has to restart from
+ *  their endpoints.
+ *  <p>
+ *  An edge that got cheaper requeues its tail. An edge of the shortest paths
+ *  tree that got more expensive resets the subtree hanging from its head back
+ *  to the super-source and requeues the subtree and its in-neighbours, found
+ *  through a reverse adjacency built with the detector.
+ *  Every other change leaves the potential feasible and costs nothing.
+ *  <p>
+ *  Negative cycles are found in the predecessor graph, as in {@link BellmanFordSP},
+ *  checked against the current weights and retired with their vertices.
+ *  Once a cycle has been found the potential is no longer feasible, so the next
+ *  update runs a full super-source search instead of an incremental one.
+ *  The structure of the digraph must not change: build a new detector, or
+ *  call {@code reset(G)}, when the digraph is refrozen.
+ */
+
+#ifndef INCREMENTAL_BELLMAN_FORD_H
+#define INCREMENTAL_BELLMAN_FORD_H
+
+#include <cstdint>
+#include <queue>
+#include <stack>
+#include <vector>
+
+#include "csr_digraph.h"
+
+class DirectedEdge;
+
+class IncrementalBellmanFord {
+public:
+    /**
+     * Computes the shortest paths from the super-source in {@code G}
+     * and collects its negative cycles.
+     * @param G the digraph in compressed sparse row form
+     */
+    explicit IncrementalBellmanFord(const CsrDigraph &G);
+    /**
+     * Forgets every distance and runs a full search on {@code G},
+     * after its structure changed.
+     * @param G the digraph in compressed sparse row form
+     */
+    void reset(const CsrDigraph &G);
+    /**
+     * Brings the shortest paths up to date after the weights of some edge slots
+     * were patched in the digraph, and returns the negative cycles the changes created.
+     * @param slots the edge slots whose weight changed since the last search
+     * @return the negative cycles found, as iterables of edges
+     */
+    const std::vector<std::stack<DirectedEdge *>> &update(const std::vector<int> &slots);
+    /**
+     * Did the last search find a negative cycle?
+     * @return {@code true} if the last search found a negative cycle
+     */
+    bool hasNegativeCycle() const { return !_cycles.empty(); }
+    /**
+     * Returns the negative cycles found by the last search.
+     * @return the negative cycles as iterables of edges, empty if there is no such cycle
+     */
+    const std::vector<std::stack<DirectedEdge *>> &negativeCycles() const { return _cycles; }
+    /**
+     * Returns the length of a shortest path from the super-source to vertex {@code v}.
+     * @param  v the destination vertex
+     * @return the length of a shortest path from the super-source to vertex {@code v}
+     * @throws IllegalArgumentException unless {@code 0 <= v < V}
+     */
+    double distTo(int v) const;
+    /**
+     * Was the last search incremental, or did it start over from the super-source?
+     * @return {@code true} if the last search only restarted from the changed edges
+     */
+    bool incremental() const { return _incremental; }
+    /**
+     * Returns the number of edges relaxed by the last search.
+     * @return the number of edges relaxed by the last search
+     */
+    long relaxations() const { return _relaxations; }
+
+private:
+    // start over from the super-source
+    void full();
+    // run the queue-based Bellman-Ford algorithm until the queue drains
+    void search();
+    // relax the edges leaving v and put the other endpoints on queue if changed
+    void relax(int v);
+    // put v on queue unless it is already there
+    void enqueue(int v);
+    // hang the subtree of w back from the super-source and requeue its frontier
+    void invalidate(int w);
+    // find the cycles of the predecessor graph, retiring their vertices
+    void findNegativeCycles();
+    // throw an IllegalArgumentException unless {@code 0 <= v < V}
+    void validateVertex(int v) const;
+
+private:
+    const CsrDigraph *_G;
+    std::vector<int> _from;                 // from[i] = tail vertex of edge slot i
+    std::vector<int> _inOffsets;            // slots entering v are inSlots[inOffsets[v] .. inOffsets[v+1]-1]
+    std::vector<int> _inSlots;
+    std::vector<double> _weight;            // weight[i] = weight of edge slot i at the last search
+    std::vector<double> _distTo;            // distTo[v] = distance of shortest super-source->v path
+    std::vector<int> _edgeTo;               // edgeTo[v] = last slot on that path, -1 from the super-source
+    std::vector<bool> _onQueue;             // onQueue[v] = is v currently on the queue?
+    std::vector<bool> _blocked;             // blocked[v] = is v on a reported cycle?
+    std::vector<uint64_t> _stamp;           // last walk of the predecessor graph through v
+    uint64_t _walk = 0;                     // number of walks so far
+    std::vector<int> _subtree;              // scratch list of invalidate()
+    std::queue<int> _queue;                 // queue of vertices to relax
+    long _cost = 0;                         // number of calls to relax() since the cycle check
+    long _relaxations = 0;                  // edges relaxed by the last search
+    bool _stale = false;                    // potential infeasible, start over on the next update
+    bool _incremental = false;              // was the last search incremental?
+    std::vector<std::stack<DirectedEdge *>> _cycles;  // negative cycles of the last search
+};
+
+#endif
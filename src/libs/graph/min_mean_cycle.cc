@@ -0,0 +1,233 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 directed_edge.cc -std=c++17
+ *                clang++ -c -O2 edge_weighted_digraph.cc -std=c++17
+ *                clang++ -c -O2 csr_digraph.cc -std=c++17
+ *                clang++ -c -O2 min_mean_cycle.cc -std=c++17
+ *  Dependencies: csr_digraph.h directed_edge.h
+ *
+ *  Minimum mean cycle with Howard's policy iteration.
+ *
+ ******************************************************************************/
+
+#include "min_mean_cycle.h"
+
+#include <cmath>
+#include <limits>
+#include <queue>
+
+#include "directed_edge.h"
+
+using std::stack;
+using std::vector;
+
+namespace {
+    // gains below this are rounding noise, not a better policy
+    constexpr double EPSILON = 1e-10;
+    // Howard's algorithm converges in a handful of iterations, this only guards against rounding loops
+    constexpr int MAX_ITERATIONS = 1000;
+}
+
+/**
+ * Prepares the searches on the frozen digraph {@code G}. Its weights are
+ * copied, later repricing of {@code G} is not seen.
+ * @param G the digraph in compressed sparse row form
+ */
+MinMeanCycle::MinMeanCycle(const CsrDigraph &G)
+        : _G(G),
+          _weight(G.weight(), G.weight() + G.E()),
+          _from(G.E()),
+          _revOffsets(G.V() + 1, 0),
+          _revSlots(G.E()),
+          _alive(G.V()),
+          _policy(G.V(), -1),
+          _eta(G.V()),
+          _x(G.V()),
+          _stamp(G.V()) {
+    for (int v = 0; v < G.V(); v++) {
+        for (int i = G.offsets()[v]; i < G.offsets()[v + 1]; i++) {
+            _from[i] = v;
+            _revOffsets[G.to()[i] + 1]++;
+        }
+    }
+    for (int v = 0; v < G.V(); v++) _revOffsets[v + 1] += _revOffsets[v];
+    vector<int> fill(_revOffsets.begin(), _revOffsets.end() - 1);
+    for (int i = 0; i < G.E(); i++) _revSlots[fill[G.to()[i]]++] = i;
+    _path.reserve(G.V());
+}
+
+/**
+ * Removes edge slot {@code i} from the next searches.
+ * @param i the edge slot
+ */
+void MinMeanCycle::ban(int i) {
+    _weight[i] = std::numeric_limits<double>::infinity();
+}
+
+/**
+ * Finds a cycle of minimum mean weight among the edges not banned.
+ * @return {@code true} if the digraph has a cycle
+ */
+bool MinMeanCycle::run() {
+    const int *offsets = _G.offsets();
+    const int *to = _G.to();
+    _cycle.clear();
+    _iterations = 0;
+
+    trim();
+
+    // start from the policy of the previous search, or the lightest edge left
+    bool any = false;
+    for (int v = 0; v < _G.V(); v++) {
+        if (!_alive[v]) continue;
+        any = true;
+        int i = _policy[v];
+        if (i >= 0 && !std::isinf(_weight[i]) && _alive[to[i]]) continue;
+        _policy[v] = -1;
+        for (i = offsets[v]; i < offsets[v + 1]; i++) {
+            if (std::isinf(_weight[i]) || !_alive[to[i]]) continue;
+            if (_policy[v] < 0 || _weight[i] < _weight[_policy[v]]) _policy[v] = i;
+        }
+    }
+    if (!any) return false;
+
+    while (true) {
+        evaluate();
+        if (++_iterations >= MAX_ITERATIONS || !improve()) break;
+    }
+
+    // walk the policy cycle of lowest mean
+    double total = 0.0;
+    int v = _best;
+    do {
+        _cycle.push_back(_policy[v]);
+        total += _weight[_policy[v]];
+        v = next(v);
+    } while (v != _best);
+    _mean = total / _cycle.size();
+    return true;
+}
+
+// remove the vertices that cannot reach a cycle: the ones left without an edge,
+// then the ones whose edges only lead to removed vertices
+void MinMeanCycle::trim() {
+    const int *offsets = _G.offsets();
+    vector<int> outdegree(_G.V());
+    std::queue<int> dead;
+    for (int v = 0; v < _G.V(); v++) {
+        _alive[v] = true;
+        for (int i = offsets[v]; i < offsets[v + 1]; i++)
+            if (!std::isinf(_weight[i])) outdegree[v]++;
+        if (outdegree[v] == 0) dead.push(v);
+    }
+    while (!dead.empty()) {
+        int w = dead.front();
+        dead.pop();
+        _alive[w] = false;
+        for (int k = _revOffsets[w]; k < _revOffsets[w + 1]; k++) {
+            int i = _revSlots[k];
+            int v = _from[i];
+            if (std::isinf(_weight[i]) || !_alive[v]) continue;
+            if (--outdegree[v] == 0) dead.push(v);
+        }
+    }
+}
+
+// follow the policy from every vertex: a walk either runs into a vertex
+// already evaluated or closes a new policy cycle, then the values are set
+// backwards along it
+void MinMeanCycle::evaluate() {
+    uint64_t first = _walk + 1;    // walks of this evaluation are numbered from here
+    _best = -1;
+    for (int v = 0; v < _G.V(); v++) {
+        if (!_alive[v] || _stamp[v] >= first) continue;
+
+        uint64_t walk = ++_walk;
+        _path.clear();
+        int x = v;
+        while (_stamp[x] < first) {
+            _stamp[x] = walk;
+            _path.push_back(x);
+            x = next(x);
+        }
+
+        size_t k = _path.size();
+        if (_stamp[x] == walk) {
+            // a new policy cycle, the tail of the walk from x
+            size_t p = k;
+            double total = 0.0;
+            do {
+                p--;
+                total += _weight[_policy[_path[p]]];
+            } while (_path[p] != x);
+            double lambda = total / (k - p);
+
+            _eta[x] = lambda;
+            _x[x] = 0.0;
+            for (size_t j = k - 1; j > p; j--) {
+                int u = _path[j];
+                _eta[u] = lambda;
+                _x[u] = _weight[_policy[u]] - lambda + _x[next(u)];
+            }
+            if (_best < 0 || lambda < _eta[_best]) _best = x;
+            k = p;
+        }
+        for (size_t j = k; j-- > 0;) {
+            int u = _path[j];
+            _eta[u] = _eta[next(u)];
+            _x[u] = _weight[_policy[u]] - _eta[u] + _x[next(u)];
+        }
+    }
+}
+
+// first to a cycle of lower mean; only if no vertex can, to a shorter
+// distance to a cycle of the same mean
+bool MinMeanCycle::improve() {
+    const int *offsets = _G.offsets();
+    const int *to = _G.to();
+
+    bool changed = false;
+    for (int v = 0; v < _G.V(); v++) {
+        if (!_alive[v]) continue;
+        int best = -1;
+        for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+            if (std::isinf(_weight[i]) || !_alive[to[i]]) continue;
+            if (_eta[to[i]] < _eta[v] - EPSILON && (best < 0 || _eta[to[i]] < _eta[to[best]])) best = i;
+        }
+        if (best >= 0) {
+            _policy[v] = best;
+            changed = true;
+        }
+    }
+    if (changed) return true;
+
+    for (int v = 0; v < _G.V(); v++) {
+        if (!_alive[v]) continue;
+        int best = -1;
+        double value = _x[v] - EPSILON;
+        for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+            int w = to[i];
+            if (std::isinf(_weight[i]) || !_alive[w] || std::fabs(_eta[w] - _eta[v]) > EPSILON) continue;
+            double candidate = _weight[i] - _eta[v] + _x[w];
+            if (candidate < value) {
+                value = candidate;
+                best = i;
+            }
+        }
+        if (best >= 0) {
+            _policy[v] = best;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+/**
+ * Returns the cycle found by the last search, from its first edge on top.
+ * @return the cycle as an iterable of edges, empty if there is no cycle
+ */
+stack<DirectedEdge *> MinMeanCycle::cycle() const {
+    stack<DirectedEdge *> cycle;
+    for (auto i = _cycle.rbegin(); i != _cycle.rend(); ++i)
+        cycle.push(_G.edge(*i));
+    return cycle;
+}
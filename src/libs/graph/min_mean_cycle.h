@@ -0,0 +1,115 @@
+/**
+ *  The {@code MinMeanCycle} class finds a cycle of minimum mean weight of a
+ *  {@link CsrDigraph} with Howard's policy iteration. On our graphs the minimum
+ *  mean cycle is the route with the best rate per swap, and it is negative
+ *  exactly when the digraph has a negative cycle.
+ *  <p>
+ *  Every vertex follows one of its edges, its <em>policy</em>. The policy
+ *  graph is a set of cycles with trees hanging off them: the value
+ *  determination gives every vertex the mean of the cycle it ends up on and
+ *  its distance to that cycle, and the policy improvement switches vertices
+ *  to an edge leading to a cycle of lower mean, or to a shorter distance
+ *  to the same one. The search stops when no vertex can improve, and the
+ *  policy cycle of lowest mean is the minimum mean cycle. Howard's algorithm
+ *  has no good bound on the number of iterations, but only takes a handful of
+ *  them in practice, each of time proportional to <em>V</em> + <em>E</em>.
+ *  <p>
+ *  Vertices that cannot reach a cycle are trimmed first, so that every vertex
+ *  left has a policy. Edges of infinite weight are ignored, and edges can be
+ *  banned, so that the next search finds another cycle. The policy of the
+ *  previous search is kept as the starting point of the next one.
+ *  <p>
+ *  For additional documentation, see A. Dasdan, <i>Experimental analysis of the
+ *  fastest optimum cycle ratio and mean algorithms</i>, ACM TODAES 9 (2004).
+ */
+
+#ifndef MIN_MEAN_CYCLE_H
+#define MIN_MEAN_CYCLE_H
+
+#include <cstdint>
+#include <stack>
+#include <vector>
+
+#include "csr_digraph.h"
+
+class DirectedEdge;
+
+class MinMeanCycle {
+public:
+    /**
+     * Prepares the searches on the frozen digraph {@code G}. Its weights are
+     * copied, later repricing of {@code G} is not seen.
+     * @param G the digraph in compressed sparse row form
+     */
+    explicit MinMeanCycle(const CsrDigraph &G);
+    /**
+     * Finds a cycle of minimum mean weight among the edges not banned.
+     * @return {@code true} if the digraph has a cycle
+     */
+    bool run();
+    /**
+     * Removes edge slot {@code i} from the next searches.
+     * @param i the edge slot
+     */
+    void ban(int i);
+    /**
+     * Did the last search find a cycle?
+     * @return {@code true} if the last search found a cycle
+     */
+    bool hasCycle() const { return !_cycle.empty(); }
+    /**
+     * Returns the mean weight of the cycle found by the last search.
+     * @return the mean weight of the cycle
+     */
+    double mean() const { return _mean; }
+    /**
+     * Returns the total weight of the cycle found by the last search.
+     * @return the total weight of the cycle
+     */
+    double weight() const { return _mean * _cycle.size(); }
+    /**
+     * Returns the edge slots of the cycle found by the last search, in path order.
+     * @return the edge slots of the cycle, empty if there is no cycle
+     */
+    const std::vector<int> &cycleSlots() const { return _cycle; }
+    /**
+     * Returns the cycle found by the last search, from its first edge on top.
+     * @return the cycle as an iterable of edges, empty if there is no cycle
+     */
+    std::stack<DirectedEdge *> cycle() const;
+    /**
+     * Returns the number of policy iterations of the last search.
+     * @return the number of policy iterations of the last search
+     */
+    int iterations() const { return _iterations; }
+
+private:
+    // remove the vertices that cannot reach a cycle
+    void trim();
+    // mean of the policy cycle every vertex ends on, and distance to that cycle
+    void evaluate();
+    // switch vertices to a better edge, false if none can improve
+    bool improve();
+    // head vertex of the policy edge of v
+    int next(int v) const { return _G.to()[_policy[v]]; }
+
+private:
+    const CsrDigraph &_G;
+    std::vector<double> _weight;        // weight[i] = weight of edge slot i, infinite once banned
+    std::vector<int> _from;             // from[i] = tail vertex of edge slot i
+    std::vector<int> _revOffsets;       // slots of the edges entering v are revSlots[revOffsets[v]..]
+    std::vector<int> _revSlots;
+    std::vector<bool> _alive;           // alive[v] = can v reach a cycle?
+    std::vector<int> _policy;           // policy[v] = slot of the edge v follows, -1 if none
+    std::vector<double> _eta;           // eta[v] = mean of the policy cycle v ends on
+    std::vector<double> _x;             // x[v] = distance of v to its policy cycle, less eta per edge
+    std::vector<uint64_t> _stamp;       // walk of the last value determination through v
+    uint64_t _walk = 0;                 // number of walks so far
+    std::vector<int> _path;             // vertices of the current walk
+    int _iterations = 0;                // policy iterations of the last search
+    double _mean = 0.0;                 // mean weight of the cycle found
+    int _best = -1;                     // a vertex on the policy cycle of lowest mean
+    std::vector<int> _cycle;            // slots of the cycle found, empty if none
+};
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ *  The {@code syntheticMarket()} function generates the synthetic DEX market
+ *  the benchmarks search: V tokens and P pools between random pairs of them.
+ *  Every token has a reference price, pools quote around it: the log rate of
+ *  a pool is the difference of the reference prices of its tokens, plus some
+ *  normal noise. Without noise the market is free of cycles once the fee is
+ *  paid, with it only a handful of mispriced cycles exist.
+ *  <p>
+ *  {@code addPool()} turns a pool into its two edges, a 0.3% fee paid in
+ *  both directions.
+ */
+
+#ifndef SYNTHETIC_MARKET_H
+#define SYNTHETIC_MARKET_H
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "directed_edge.h"
+#include "edge_weighted_digraph.h"
+
+/**
+ * A pool of the synthetic market, quoting token {@code w} in token {@code v}.
+ */
+struct SyntheticPool {
+    int v;
+    int w;
+    double mid;     // log rate from v to w at the reference prices
+    double noise;   // log mispricing of the pool
+};
+
+/**
+ * Generates the pools of a synthetic market, the same ones for the same arguments.
+ * @param V the number of tokens
+ * @param P the number of pools drawn, the ones drawn between a token and itself are dropped
+ * @param seed the seed of the generator
+ * @param sigma the standard deviation of the log mispricing of the pools
+ * @return the pools
+ */
+inline std::vector<SyntheticPool> syntheticMarket(int V, int P, unsigned seed, double sigma) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<> vertex(0, V - 1);
+    std::normal_distribution<> log_price(0.0, 1.0);
+    std::normal_distribution<> noise(0.0, sigma);
+
+    // every token has a reference price, pools quote around it
+    std::vector<double> reference(V);
+    for (int v = 0; v < V; v++) reference[v] = log_price(gen);
+
+    std::vector<SyntheticPool> pools;
+    pools.reserve(P);
+    for (int i = 0; i < P; i++) {
+        int v = vertex(gen);
+        int w = vertex(gen);
+        if (v == w) continue;
+        pools.push_back({v, w, reference[w] - reference[v], noise(gen)});
+    }
+    return pools;
+}
+
+/**
+ * Adds both edges of a pool with log rate {@code rate} from {@code v} to {@code w},
+ * less a 0.3% fee each way.
+ * @param G the digraph
+ * @param v one token of the pool
+ * @param w the other token of the pool
+ * @param rate the log rate from v to w
+ */
+inline void addPool(EdgeWeightedDigraph &G, int v, int w, double rate) {
+    const double fee = std::log(1 - 0.003);
+    G.addEdge(new DirectedEdge(v, w, -(rate + fee)));
+    G.addEdge(new DirectedEdge(w, v, -(-rate + fee)));
+}
+
+#endif
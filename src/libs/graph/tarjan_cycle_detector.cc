@@ -0,0 +1,171 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 directed_edge.cc -std=c++17
+ *                clang++ -c -O2 edge_weighted_digraph.cc -std=c++17
+ *                clang++ -c -O2 csr_digraph.cc -std=c++17
+ *                clang++ -c -O2 tarjan_cycle_detector.cc -std=c++17
+ *  Dependencies: csr_digraph.h directed_edge.h
+ *
+ *  Negative cycle detection with Tarjan's subtree disassembly, from a
+ *  virtual super-source linked to every vertex.
+ *
+ ******************************************************************************/
+
+#include "tarjan_cycle_detector.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "directed_edge.h"
+
+using std::stack;
+
+/**
+ * Collects every negative cycle of the frozen digraph {@code G} from a virtual super-source.
+ * @param G the digraph in compressed sparse row form
+ */
+TarjanCycleDetector::TarjanCycleDetector(const CsrDigraph &G)
+        : _G(G), _root(G.V()),
+          _distTo(G.V(), 0.0),
+          _edgeTo(G.V(), -1),
+          _from(G.E()),
+          _next(G.V() + 1),
+          _prev(G.V() + 1),
+          _depth(G.V() + 1, 1),
+          _inTree(G.V(), true),
+          _dirty(G.V(), true),
+          _onQueue(G.V()),
+          _blocked(G.V()) {
+    for (int v = 0; v < G.V(); v++)
+        for (int i = G.offsets()[v]; i < G.offsets()[v + 1]; i++)
+            _from[i] = v;
+
+    // the super-source reaches every vertex through a zero-weight edge:
+    // the thread starts as the root followed by all its children
+    _depth[_root] = 0;
+    for (int v = 0; v <= _root; v++) {
+        _next[v] = v == _root ? 0 : v + 1;
+        _prev[v] = v == 0 ? _root : v - 1;
+    }
+    if (G.V() == 0) _next[_root] = _prev[_root] = _root;
+    for (int v = 0; v < G.V(); v++) enqueue(v);
+
+    while (!_queue.empty()) {
+        int v = _queue.front();
+        _queue.pop();
+        _onQueue[v] = false;
+        if (!_inTree[v] || _blocked[v]) continue;   // stale label, a shorter path will bring it back
+        _scans++;
+        _dirty[v] = false;
+        relax(v);
+    }
+}
+
+// scan vertex v, relaxing the edges leaving it
+void TarjanCycleDetector::relax(int v) {
+    const int *offsets = _G.offsets();
+    const int *to = _G.to();
+    const double *weight = _G.weight();
+    for (int i = offsets[v]; i < offsets[v + 1]; i++) {
+        int w = to[i];
+        if (_blocked[w]) continue;       // already part of a reported cycle
+        double distance = _distTo[v] + weight[i];
+        if (!(distance < _distTo[w])) continue;
+
+        if (w == v) {
+            retire(i);
+            return;
+        }
+
+        if (_inTree[w]) {
+            // take the subtree of w apart, unless it holds v: then v->w closes a cycle
+            int last = w;
+            for (int u = _next[w]; _depth[u] > _depth[w]; u = _next[u]) {
+                if (u == v) {
+                    retire(i);
+                    return;
+                }
+                last = u;
+            }
+            int after = _next[last];
+            _next[_prev[w]] = after;
+            _prev[after] = _prev[w];
+            for (int u = w; u != after; u = _next[u]) _inTree[u] = false;
+        }
+
+        _distTo[w] = distance;
+        _edgeTo[w] = i;
+        _dirty[w] = true;
+        attach(w, v);
+        enqueue(w);
+    }
+}
+
+// link w into the tree as the first child of p
+void TarjanCycleDetector::attach(int w, int p) {
+    _next[w] = _next[p];
+    _prev[w] = p;
+    _prev[_next[p]] = w;
+    _next[p] = w;
+    _depth[w] = _depth[p] + 1;
+    _inTree[w] = true;
+}
+
+// retire the vertices of the cycle closed by slot i, v->w, and put back under
+// the root the vertices left out of the tree with a label never scanned
+void TarjanCycleDetector::retire(int i) {
+    int v = _from[i];
+    int w = _G.to()[i];
+
+    // the tree path from w down to v, then v->w, with the edge leaving w on top
+    stack<DirectedEdge *> cycle;
+    double weight = _G.weight()[i];
+    cycle.push(_G.edge(i));
+    for (int y = v; y != w; y = _from[_edgeTo[y]]) {
+        cycle.push(_G.edge(_edgeTo[y]));
+        weight += _G.weight()[_edgeTo[y]];
+    }
+    if (weight < 0.0) _cycles.emplace_back(cycle);
+
+    _blocked[w] = true;
+    for (int y = v; y != w; y = _from[_edgeTo[y]]) _blocked[y] = true;
+
+    // the cycle hangs from the subtree of w, which leaves the tree with it
+    int after = _next[w];
+    while (_depth[after] > _depth[w]) after = _next[after];
+    _next[_prev[w]] = after;
+    _prev[after] = _prev[w];
+    for (int u = w; u != after; u = _next[u]) _inTree[u] = false;
+
+    // vertices waiting on a retired ancestor for a shorter path would wait forever
+    // with a label their neighbours have not seen yet
+    for (int u = 0; u < _G.V(); u++) {
+        if (_blocked[u] || _inTree[u] || !_dirty[u]) continue;
+        _edgeTo[u] = -1;
+        attach(u, _root);
+        enqueue(u);
+    }
+}
+
+// put v on the queue unless it is already there
+void TarjanCycleDetector::enqueue(int v) {
+    if (_onQueue[v]) return;
+    _queue.push(v);
+    _onQueue[v] = true;
+}
+
+/**
+ * Returns the length of a shortest path from the super-source to vertex {@code v}.
+ * @param  v the destination vertex
+ * @return the length of a shortest path from the super-source to vertex {@code v}
+ * @throws IllegalArgumentException unless {@code 0 <= v < V}
+ */
+double TarjanCycleDetector::distTo(int v) const {
+    validateVertex(v);
+    return _distTo[v];
+}
+
+// throw an IllegalArgumentException unless {@code 0 <= v < V}
+void TarjanCycleDetector::validateVertex(int v) const {
+    if (v < 0 || v >= _G.V())
+        throw std::invalid_argument("vertex " + std::to_string(v) + " is not between 0 and " + std::to_string(_G.V() - 1));
+}
@@ -0,0 +1,177 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 directed_edge.cc -std=c++17
+ *                clang++ -c -O2 edge_weighted_digraph.cc -std=c++17
+ *                clang++ -c -O2 csr_digraph.cc -std=c++17
+ *                clang++ -O2 -DDebug tarjan_scc.cc csr_digraph.o edge_weighted_digraph.o directed_edge.o -std=c++17 -o tarjan_scc
+ *  Execution:    ./tarjan_scc filename.txt
+ *  Dependencies: edge_weighted_digraph.h csr_digraph.h directed_edge.h
+ *  Data files:   https://algs4.cs.princeton.edu/44sp/tinyEWD.txt
+ *
+ *  Compute the strongly-connected components of an edge-weighted digraph
+ *  using Tarjan's algorithm.
+ *
+ *  Runs in O(E + V) time.
+ *
+ *  % tarjan_scc tinyEWD.txt
+ *  1 strong components
+ *  0 1 2 3 4 5 6 7
+ *
+ ******************************************************************************/
+
+#include "tarjan_scc.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "directed_edge.h"
+
+using std::vector;
+
+/**
+ * Computes the strong components of the edge-weighted digraph {@code G}.
+ * @param G the edge-weighted digraph
+ */
+TarjanSCC::TarjanSCC(const EdgeWeightedDigraph &G) {
+    _marked.resize(G.V());
+    _id.resize(G.V());
+    _low.resize(G.V());
+    _min.resize(G.V());
+    for (int v = 0; v < G.V(); v++) {
+        if (!_marked[v]) dfs(G, v);
+    }
+}
+
+/**
+ * Computes the strong components of the frozen digraph {@code G}.
+ * @param G the digraph in compressed sparse row form
+ */
+TarjanSCC::TarjanSCC(const CsrDigraph &G) {
+    _marked.resize(G.V());
+    _id.resize(G.V());
+    _low.resize(G.V());
+    _min.resize(G.V());
+    for (int v = 0; v < G.V(); v++) {
+        if (!_marked[v]) dfs(G, v);
+    }
+}
+
+// depth-first search from s, one frame per vertex on the path
+template<typename Digraph>
+void TarjanSCC::dfs(const Digraph &G, int s) {
+    struct Frame {
+        int v;      // vertex
+        int next;   // next edge of adj(v) to follow
+    };
+    vector<Frame> path;
+
+    auto open = [&](int v) {
+        _marked[v] = true;
+        _low[v] = _pre++;
+        _min[v] = _low[v];
+        _stack.push_back(v);
+        path.push_back({v, 0});
+    };
+
+    open(s);
+    while (!path.empty()) {
+        int v = path.back().v;
+        const auto &adj = G.adj(v);
+        if (path.back().next < (int) adj.size()) {
+            const DirectedEdge *e = adj.begin()[path.back().next++];
+            if (std::isinf(e->weight())) continue;   // no path goes through it
+            int w = e->to();
+            if (!_marked[w]) open(w);
+            else if (_low[w] < _min[v]) _min[v] = _low[w];
+            continue;
+        }
+
+        // every edge of v followed: either v roots a component or it hands its low number up
+        path.pop_back();
+        if (_min[v] < _low[v]) {
+            _low[v] = _min[v];
+        } else {
+            int w;
+            do {
+                w = _stack.back();
+                _stack.pop_back();
+                _id[w] = _count;
+                _low[w] = G.V();
+            } while (w != v);
+            _count++;
+        }
+        if (!path.empty() && _low[v] < _min[path.back().v]) _min[path.back().v] = _low[v];
+    }
+}
+
+/**
+ * Are vertices {@code v} and {@code w} in the same strong component?
+ * @param  v one vertex
+ * @param  w the other vertex
+ * @return {@code true} if vertices {@code v} and {@code w} are in the same
+ *         strong component, and {@code false} otherwise
+ * @throws IllegalArgumentException unless {@code 0 <= v < V}
+ * @throws IllegalArgumentException unless {@code 0 <= w < V}
+ */
+bool TarjanSCC::stronglyConnected(int v, int w) const {
+    validateVertex(v);
+    validateVertex(w);
+    return _id[v] == _id[w];
+}
+
+/**
+ * Returns the component id of the strong component containing vertex {@code v}.
+ * @param  v the vertex
+ * @return the component id of the strong component containing vertex {@code v}
+ * @throws IllegalArgumentException unless {@code 0 <= v < V}
+ */
+int TarjanSCC::id(int v) const {
+    validateVertex(v);
+    return _id[v];
+}
+
+/**
+ * Returns the vertices of every strong component, indexed by component id.
+ * @return the vertices of every strong component
+ */
+vector<vector<int>> TarjanSCC::components() const {
+    vector<vector<int>> components(_count);
+    for (int v = 0; v < (int) _id.size(); v++)
+        components[_id[v]].push_back(v);
+    return components;
+}
+
+// throw an IllegalArgumentException unless {@code 0 <= v < V}
+void TarjanSCC::validateVertex(int v) const {
+    int V = _marked.size();
+    if (v < 0 || v >= V)
+        throw std::invalid_argument("vertex " + std::to_string(v) + " is not between 0 and " + std::to_string(V - 1));
+}
+
+/**
+ * Unit tests the {@code TarjanSCC} data type.
+ *
+ * @param args the command-line arguments
+ */
+#ifdef Debug
+
+#include <cstdio>
+#include <fstream>
+
+int main(int argc, char *argv[]) {
+    std::fstream in(argv[1]);
+    EdgeWeightedDigraph G(in);
+    TarjanSCC scc(G);
+
+    // number of connected components
+    printf("%d strong components\n", scc.count());
+
+    // print the vertices of every component
+    for (const vector<int> &component : scc.components()) {
+        for (int v : component) printf("%d ", v);
+        printf("\n");
+    }
+
+    return 0;
+}
+#endif
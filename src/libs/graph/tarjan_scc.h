@@ -0,0 +1,101 @@
+/**
+ *  The {@code TarjanSCC} class represents a data type for
+ *  determining the strong components in a digraph.
+ *  The <em>id</em> operation determines in which strong component
+ *  a given vertex lies; the <em>stronglyConnected</em> operation
+ *  determines whether two vertices are in the same strong component;
+ *  and the <em>count</em> operation determines the number of strong
+ *  components.
+ *  <p>
+ *  The <em>component identifier</em> of a component is an integer between
+ *  0 and <em>count</em> - 1: two vertices have the same component
+ *  identifier if and only if they are in the same strong component.
+ *  <p>
+ *  This implementation uses Tarjan's algorithm, with an explicit stack
+ *  instead of recursion so that long paths cannot overflow the call stack.
+ *  The constructor takes time proportional to <em>V</em> + <em>E</em>
+ *  (in the worst case),
+ *  where <em>V</em> is the number of vertices and <em>E</em> is the number of edges.
+ *  Afterwards, the <em>id</em>, <em>count</em>, and <em>stronglyConnected</em>
+ *  operations take constant time.
+ *  <p>
+ *  Edges of infinite weight, the ones of deactivated pools, are ignored
+ *  as no path can go through them.
+ *  Every directed cycle lies inside a single strong component, so the
+ *  components of one vertex, which carry no cycle, can be pruned before
+ *  looking for negative cycles.
+ *  <p>
+ *  For additional documentation,
+ *  see <a href="https://algs4.cs.princeton.edu/42digraph">Section 4.2</a> of
+ *  <i>Algorithms, 4th Edition</i> by Robert Sedgewick and Kevin Wayne.
+ *
+ *  @author Robert Sedgewick
+ *  @author Kevin Wayne
+ */
+
+#ifndef TARJAN_SCC_H
+#define TARJAN_SCC_H
+
+#include <vector>
+
+#include "edge_weighted_digraph.h"
+#include "csr_digraph.h"
+
+class TarjanSCC {
+public:
+    /**
+     * Computes the strong components of the edge-weighted digraph {@code G}.
+     * @param G the edge-weighted digraph
+     */
+    explicit TarjanSCC(const EdgeWeightedDigraph &G);
+    /**
+     * Computes the strong components of the frozen digraph {@code G}.
+     * @param G the digraph in compressed sparse row form
+     */
+    explicit TarjanSCC(const CsrDigraph &G);
+    /**
+     * Returns the number of strong components.
+     * @return the number of strong components
+     */
+    int count() const { return _count; }
+    /**
+     * Are vertices {@code v} and {@code w} in the same strong component?
+     * @param  v one vertex
+     * @param  w the other vertex
+     * @return {@code true} if vertices {@code v} and {@code w} are in the same
+     *         strong component, and {@code false} otherwise
+     * @throws IllegalArgumentException unless {@code 0 <= v < V}
+     * @throws IllegalArgumentException unless {@code 0 <= w < V}
+     */
+    bool stronglyConnected(int v, int w) const;
+    /**
+     * Returns the component id of the strong component containing vertex {@code v}.
+     * @param  v the vertex
+     * @return the component id of the strong component containing vertex {@code v}
+     * @throws IllegalArgumentException unless {@code 0 <= v < V}
+     */
+    int id(int v) const;
+    /**
+     * Returns the vertices of every strong component, indexed by component id.
+     * @return the vertices of every strong component
+     */
+    std::vector<std::vector<int>> components() const;
+
+private:
+    // depth-first search from s, one frame per vertex on the path
+    template<typename Digraph>
+    void dfs(const Digraph &G, int s);
+    // throw an IllegalArgumentException unless {@code 0 <= v < V}
+    void validateVertex(int v) const;
+
+private:
+    std::vector<bool> _marked;      // marked[v] = has v been visited?
+    std::vector<int> _id;           // id[v] = id of strong component containing v
+    std::vector<int> _low;          // low[v] = low number of v
+    std::vector<int> _min;          // min[v] = lowest low number reached from v so far
+    int _pre = 0;                   // preorder number counter
+    int _count = 0;                 // number of strongly-connected components
+    std::vector<int> _stack;        // vertices of the components not yet closed
+};
+
+#endif
@@ -0,0 +1,81 @@
+/******************************************************************************
+ *  Compilation:  clang++ -c -O2 directed_edge.cc -std=c++17
+ *                clang++ -c -O2 edge_weighted_digraph.cc -std=c++17
+ *                clang++ -c -O2 csr_digraph.cc -std=c++17
+ *                clang++ -c -O2 min_mean_cycle.cc -std=c++17
+ *                clang++ -c -O2 cycle_key.cc -std=c++17
+ *                clang++ -c -O2 top_k_cycles.cc -std=c++17
+ *  Dependencies: csr_digraph.h cycle_key.h directed_edge.h min_mean_cycle.h
+ *
+ *  The K negative cycles of lowest total weight.
+ *
+ ******************************************************************************/
+
+#include "top_k_cycles.h"
+
+#include <algorithm>
+
+#include "cycle_key.h"
+#include "directed_edge.h"
+#include "min_mean_cycle.h"
+
+using std::stack;
+using std::vector;
+
+/**
+ * Keeps the {@code k} best negative cycles.
+ * @param k the number of cycles kept
+ */
+TopKCycles::TopKCycles(int k) : _k(std::max(0, k)) {}
+
+/**
+ * Offers a candidate cycle, ignored unless it is negative and not seen before.
+ * @param cycle the cycle, from its first edge on top
+ * @return {@code true} if the cycle is a new negative cycle
+ */
+bool TopKCycles::offer(const stack<DirectedEdge *> &cycle) {
+    double weight = 0.0;
+    for (stack<DirectedEdge *> edges(cycle); !edges.empty(); edges.pop())
+        weight += edges.top()->weight();
+    if (cycle.empty() || !(weight < 0.0)) return false;
+
+    if (!_seen.insert(cycleKey(cycle)).second) return false;
+    _candidates.push_back({cycle, weight});
+    return true;
+}
+
+/**
+ * Offers the cycles of lowest mean weight of {@code G}, banning an edge of
+ * each one found, for at most {@code rounds} rounds.
+ * @param G the digraph in compressed sparse row form
+ * @param rounds the largest number of cycles searched for
+ * @return the number of new negative cycles offered
+ */
+int TopKCycles::search(const CsrDigraph &G, int rounds) {
+    MinMeanCycle mmc(G);
+    int found = 0;
+    for (int r = 0; r < rounds && mmc.run() && mmc.mean() < 0.0; r++) {
+        if (offer(mmc.cycle())) found++;
+
+        const vector<int> &slots = mmc.cycleSlots();
+        int heaviest = *std::max_element(slots.begin(), slots.end(), [&G](int i, int j) {
+            return G.weight()[i] < G.weight()[j];
+        });
+        mmc.ban(heaviest);
+    }
+    return found;
+}
+
+/**
+ * Returns the {@code k} best negative cycles offered, the most profitable first.
+ * @return the best negative cycles, ranked
+ */
+vector<TopKCycles::Candidate> TopKCycles::ranked() const {
+    vector<Candidate> best(_candidates);
+    size_t k = std::min(best.size(), size_t(_k));
+    std::partial_sort(best.begin(), best.begin() + k, best.end(), [](const Candidate &a, const Candidate &b) {
+        return a.weight < b.weight;
+    });
+    best.resize(k);
+    return best;
+}
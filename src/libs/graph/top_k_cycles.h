@@ -0,0 +1,84 @@
+/**
+ *  The {@code TopKCycles} class keeps the <em>K</em> negative cycles of lowest
+ *  total weight, the highest rate products, out of the candidates it is offered.
+ *  The detectors stop at whatever negative cycle they run into first, and the
+ *  same cycle tends to be found from many sources, so ranking their output
+ *  leaves the simulation with the few routes worth paying a call for.
+ *  <p>
+ *  Candidates also come from {@code search()}, which asks {@link MinMeanCycle}
+ *  for the cycle of lowest mean weight, bans its heaviest edge so that the next
+ *  round finds another cycle, and so on until no negative cycle is left or the
+ *  rounds are spent. Banning the heaviest edge keeps the most profitable swaps
+ *  of the cycle available to the others going through them.
+ *  <p>
+ *  A cycle is identified by its pools and directions, up to rotation, so the
+ *  same route found on the full graph and on a copy of a strong component
+ *  is only kept once.
+ */
+
+#ifndef TOP_K_CYCLES_H
+#define TOP_K_CYCLES_H
+
+#include <cmath>
+#include <cstdint>
+#include <stack>
+#include <unordered_set>
+#include <vector>
+
+#include "csr_digraph.h"
+
+class DirectedEdge;
+
+class TopKCycles {
+public:
+    /**
+     * A negative cycle and its total weight.
+     */
+    struct Candidate {
+        std::stack<DirectedEdge *> cycle;
+        double weight;
+
+        /**
+         * Returns the expected return of the cycle, its rate product less one.
+         * @return the expected return of the cycle
+         */
+        [[nodiscard]] double profit() const { return std::expm1(-weight); }
+    };
+
+    /**
+     * Keeps the {@code k} best negative cycles.
+     * @param k the number of cycles kept
+     */
+    explicit TopKCycles(int k);
+    /**
+     * Offers a candidate cycle, ignored unless it is negative and not seen before.
+     * @param cycle the cycle, from its first edge on top
+     * @return {@code true} if the cycle is a new negative cycle
+     */
+    bool offer(const std::stack<DirectedEdge *> &cycle);
+    /**
+     * Offers the cycles of lowest mean weight of {@code G}, banning an edge of
+     * each one found, for at most {@code rounds} rounds.
+     * @param G the digraph in compressed sparse row form
+     * @param rounds the largest number of cycles searched for
+     * @return the number of new negative cycles offered
+     */
+    int search(const CsrDigraph &G, int rounds);
+    /**
+     * Returns the {@code k} best negative cycles offered, the most profitable first.
+     * @return the best negative cycles, ranked
+     */
+    [[nodiscard]] std::vector<Candidate> ranked() const;
+    /**
+     * Returns the number of distinct negative cycles offered.
+     * @return the number of distinct negative cycles offered
+     */
+    [[nodiscard]] int candidates() const { return _candidates.size(); }
+
+private:
+    int _k;                                     // number of cycles kept
+    std::vector<Candidate> _candidates;         // every distinct negative cycle offered
+    std::unordered_set<uint64_t> _seen;         // keys of the cycles offered, see cycleKey()
+};
+
+#endif
@@ -6,6 +6,7 @@
 
 #include <cmath>
 #include <iostream>
+#include "misc/uint256.h"
 
 using namespace std;
 
@@ -155,4 +156,127 @@ inline double calcInGivenOut(double tokenBalanceIn,
 // tW = totalWeight           -------------------------------------------------------------  //
 // sF = swapFee                                        ( 1 - eF )                            //
 // eF = exitFee                                                                              //
-**********************************************************************************************/
\ No newline at end of file
+**********************************************************************************************/
+
+
+/**********************************************************************************************
+// Exact integer versions, computing the same amounts as the contracts down to the last wei.  //
+// The double versions above are for screening, these for the final check of a candidate.    //
+**********************************************************************************************/
+
+/**********************************************************************************************
+// getAmountOut (Uniswap V2)                                                                 //
+// aI = amountIn                           aI * fN * rO                                      //
+// rI = reserveIn               aO = ---------------------------                             //
+// rO = reserveOut                    rI * fD + aI * fN                                      //
+// fN / fD = 1 - swapFee, 997 / 1000 on Uniswap                                              //
+**********************************************************************************************/
+inline utils::uint256 getAmountOut(const utils::uint256 &amountIn,
+                                   const utils::uint256 &reserveIn,
+                                   const utils::uint256 &reserveOut,
+                                   uint64_t feeNumerator = 997,
+                                   uint64_t feeDenominator = 1000) {
+    if (amountIn.isZero() || reserveIn.isZero() || reserveOut.isZero()) return utils::uint256();
+    utils::uint256 amountInWithFee = amountIn * feeNumerator;
+    utils::uint256 numerator = amountInWithFee * reserveOut;
+    utils::uint256 denominator = reserveIn * feeDenominator + amountInWithFee;
+    return numerator / denominator;
+}
+
+// Balancer fixed point, 18 decimals
+namespace bmath {
+    const utils::uint256 BONE = utils::uint256(1000000000000000000ULL);
+    const utils::uint256 BPOW_PRECISION = BONE / utils::uint256(10000000000ULL);
+
+    inline utils::uint256 bmul(const utils::uint256 &a, const utils::uint256 &b) {
+        return (a * b + BONE / 2) / BONE;
+    }
+
+    inline utils::uint256 bdiv(const utils::uint256 &a, const utils::uint256 &b) {
+        return (a * BONE + b / 2) / b;
+    }
+
+    // a - b and whether it went negative, as |a - b|
+    inline utils::uint256 bsubSign(const utils::uint256 &a, const utils::uint256 &b, bool &negative) {
+        negative = a < b;
+        return negative ? b - a : a - b;
+    }
+
+    inline utils::uint256 bpowi(utils::uint256 a, utils::uint256 n) {
+        utils::uint256 z = (n.limb[0] & 1) ? a : BONE;
+        for (n >>= 1; !n.isZero(); n >>= 1) {
+            a = bmul(a, a);
+            if (n.limb[0] & 1) z = bmul(z, a);
+        }
+        return z;
+    }
+
+    // base^exp for a fractional exp, by the binomial series, until a term falls below precision
+    inline utils::uint256 bpowApprox(const utils::uint256 &base, const utils::uint256 &exp,
+                                     const utils::uint256 &precision) {
+        bool xneg;
+        utils::uint256 x = bsubSign(base, BONE, xneg);
+        utils::uint256 term = BONE;
+        utils::uint256 sum = term;
+        bool negative = false;
+        for (uint64_t i = 1; term >= precision; i++) {
+            utils::uint256 bigK = BONE * i;
+            bool cneg;
+            utils::uint256 c = bsubSign(exp, bigK - BONE, cneg);
+            term = bmul(term, bmul(c, x));
+            term = bdiv(term, bigK);
+            if (term.isZero()) break;
+            if (xneg) negative = !negative;
+            if (cneg) negative = !negative;
+            if (negative) {
+                sum -= term;
+            } else {
+                sum += term;
+            }
+        }
+        return sum;
+    }
+
+    inline utils::uint256 bpow(const utils::uint256 &base, const utils::uint256 &exp) {
+        utils::uint256 whole = exp / BONE;
+        utils::uint256 remain = exp - whole * BONE;
+        utils::uint256 wholePow = bpowi(base, whole);
+        if (remain.isZero()) return wholePow;
+        utils::uint256 partialResult = bpowApprox(base, remain, BPOW_PRECISION);
+        return bmul(wholePow, partialResult);
+    }
+}
+
+/**********************************************************************************************
+// calcOutGivenIn, as BMath.sol: balances and amounts in wei, weights and fee in BONE units   //
+**********************************************************************************************/
+inline utils::uint256 calcOutGivenIn(const utils::uint256 &tokenBalanceIn,
+                                     const utils::uint256 &tokenWeightIn,
+                                     const utils::uint256 &tokenBalanceOut,
+                                     const utils::uint256 &tokenWeightOut,
+                                     const utils::uint256 &tokenAmountIn,
+                                     const utils::uint256 &swapFee) {
+    using namespace bmath;
+    utils::uint256 weightRatio = bdiv(tokenWeightIn, tokenWeightOut);
+    utils::uint256 adjustedIn = bmul(tokenAmountIn, BONE - swapFee);
+    utils::uint256 y = bdiv(tokenBalanceIn, tokenBalanceIn + adjustedIn);
+    utils::uint256 foo = bpow(y, weightRatio);
+    utils::uint256 bar = BONE - foo;
+    return bmul(tokenBalanceOut, bar);
+}
+
+/**********************************************************************************************
+// calcSpotPrice, as BMath.sol                                                               //
+**********************************************************************************************/
+inline utils::uint256 calcSpotPrice(const utils::uint256 &tokenBalanceIn,
+                                    const utils::uint256 &tokenWeightIn,
+                                    const utils::uint256 &tokenBalanceOut,
+                                    const utils::uint256 &tokenWeightOut,
+                                    const utils::uint256 &swapFee) {
+    using namespace bmath;
+    utils::uint256 numer = bdiv(tokenBalanceIn, tokenWeightIn);
+    utils::uint256 denom = bdiv(tokenBalanceOut, tokenWeightOut);
+    utils::uint256 ratio = bdiv(numer, denom);
+    utils::uint256 scale = bdiv(BONE, BONE - swapFee);
+    return bmul(ratio, scale);
+}
@@ -0,0 +1,337 @@
+//
+// Fixed-width 256-bit unsigned integer, wrapping like the EVM uint256
+//
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace utils {
+
+    class uint256 {
+    public:
+        uint64_t limb[4];   // least significant first
+
+        constexpr uint256() : limb{0, 0, 0, 0} {}
+
+        constexpr uint256(uint64_t value) : limb{value, 0, 0, 0} {}
+
+        constexpr uint256(uint64_t l3, uint64_t l2, uint64_t l1, uint64_t l0) : limb{l0, l1, l2, l3} {}
+
+        /** \brief 64 x 64 -> 128 bit product
+         * \param a first factor
+         * \param b second factor
+         * \param hi set to the high 64 bits of the product
+         * \return the low 64 bits of the product
+         */
+        static uint64_t mul64(uint64_t a, uint64_t b, uint64_t &hi) {
+#if defined(__SIZEOF_INT128__)
+            unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+            hi = static_cast<uint64_t>(p >> 64);
+            return static_cast<uint64_t>(p);
+#else
+            uint64_t a_lo = a & 0xffffffffULL, a_hi = a >> 32;
+            uint64_t b_lo = b & 0xffffffffULL, b_hi = b >> 32;
+            uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+            uint64_t mid = (ll >> 32) + (lh & 0xffffffffULL) + (hl & 0xffffffffULL);
+            hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+            return (mid << 32) | (ll & 0xffffffffULL);
+#endif
+        }
+
+        bool isZero() const { return (limb[0] | limb[1] | limb[2] | limb[3]) == 0; }
+
+        explicit operator bool() const { return !isZero(); }
+
+        /** \brief Number of significant bits, 0 for zero */
+        int bits() const {
+            for (int i = 3; i >= 0; i--) {
+                if (limb[i]) return 64 * i + 64 - __builtin_clzll(limb[i]);
+            }
+            return 0;
+        }
+
+        bool fitsUint64() const { return (limb[1] | limb[2] | limb[3]) == 0; }
+
+        uint256 &operator+=(const uint256 &b) {
+            uint64_t carry = 0;
+            for (int i = 0; i < 4; i++) {
+                uint64_t s = limb[i] + carry;
+                carry = s < carry;
+                limb[i] = s + b.limb[i];
+                carry += limb[i] < s;
+            }
+            return *this;
+        }
+
+        uint256 &operator-=(const uint256 &b) {
+            uint64_t borrow = 0;
+            for (int i = 0; i < 4; i++) {
+                uint64_t d = limb[i] - b.limb[i];
+                uint64_t next = limb[i] < b.limb[i];
+                limb[i] = d - borrow;
+                borrow = next + (d < borrow);
+            }
+            return *this;
+        }
+
+        uint256 &operator*=(const uint256 &b) {
+            // schoolbook on 64-bit limbs, the products above 2^256 are dropped
+            uint256 r;
+            for (int i = 0; i < 4; i++) {
+                if (limb[i] == 0) continue;
+                uint64_t carry = 0;
+                for (int j = 0; i + j < 4; j++) {
+                    uint64_t hi;
+                    uint64_t lo = mul64(limb[i], b.limb[j], hi);
+                    lo += carry;
+                    hi += lo < carry;
+                    r.limb[i + j] += lo;
+                    hi += r.limb[i + j] < lo;
+                    carry = hi;
+                }
+            }
+            return *this = r;
+        }
+
+        uint256 &operator<<=(int n) {
+            if (n >= 256) return *this = uint256();
+            int words = n / 64, shift = n % 64;
+            for (int i = 3; i >= 0; i--) {
+                uint64_t v = i - words >= 0 ? limb[i - words] << shift : 0;
+                if (shift && i - words - 1 >= 0) v |= limb[i - words - 1] >> (64 - shift);
+                limb[i] = v;
+            }
+            return *this;
+        }
+
+        uint256 &operator>>=(int n) {
+            if (n >= 256) return *this = uint256();
+            int words = n / 64, shift = n % 64;
+            for (int i = 0; i < 4; i++) {
+                uint64_t v = i + words < 4 ? limb[i + words] >> shift : 0;
+                if (shift && i + words + 1 < 4) v |= limb[i + words + 1] << (64 - shift);
+                limb[i] = v;
+            }
+            return *this;
+        }
+
+        /** \brief Quotient and remainder, throws on a zero divisor like the EVM reverts
+         * \param a dividend
+         * \param b divisor
+         * \param q set to a / b
+         * \param r set to a % b
+         */
+        static void divmod(const uint256 &a, const uint256 &b, uint256 &q, uint256 &r) {
+            if (b.isZero()) throw std::domain_error("uint256 division by zero");
+            q = uint256();
+#if defined(__SIZEOF_INT128__)
+            if (b.fitsUint64()) {
+                // one 128 / 64 bit step per limb
+                unsigned __int128 rem = 0;
+                for (int i = 3; i >= 0; i--) {
+                    unsigned __int128 cur = (rem << 64) | a.limb[i];
+                    q.limb[i] = static_cast<uint64_t>(cur / b.limb[0]);
+                    rem = cur % b.limb[0];
+                }
+                r = uint256(static_cast<uint64_t>(rem));
+                return;
+            }
+#endif
+            // shift and subtract, from the highest bit the quotient can have
+            r = a;
+            int shift = a.bits() - b.bits();
+            if (shift < 0) return;
+            uint256 d = b;
+            d <<= shift;
+            for (; shift >= 0; shift--) {
+                if (r >= d) {
+                    r -= d;
+                    q.limb[shift / 64] |= uint64_t(1) << (shift % 64);
+                }
+                d >>= 1;
+            }
+        }
+
+        uint256 &operator/=(const uint256 &b) {
+            uint256 q, r;
+            divmod(*this, b, q, r);
+            return *this = q;
+        }
+
+        uint256 &operator%=(const uint256 &b) {
+            uint256 q, r;
+            divmod(*this, b, q, r);
+            return *this = r;
+        }
+
+        friend uint256 operator+(uint256 a, const uint256 &b) { return a += b; }
+
+        friend uint256 operator-(uint256 a, const uint256 &b) { return a -= b; }
+
+        friend uint256 operator*(uint256 a, const uint256 &b) { return a *= b; }
+
+        friend uint256 operator/(uint256 a, const uint256 &b) { return a /= b; }
+
+        friend uint256 operator%(uint256 a, const uint256 &b) { return a %= b; }
+
+        friend uint256 operator<<(uint256 a, int n) { return a <<= n; }
+
+        friend uint256 operator>>(uint256 a, int n) { return a >>= n; }
+
+        friend bool operator==(const uint256 &a, const uint256 &b) {
+            return a.limb[0] == b.limb[0] && a.limb[1] == b.limb[1] && a.limb[2] == b.limb[2] &&
+                   a.limb[3] == b.limb[3];
+        }
+
+        friend bool operator!=(const uint256 &a, const uint256 &b) { return !(a == b); }
+
+        friend bool operator<(const uint256 &a, const uint256 &b) {
+            for (int i = 3; i >= 0; i--) {
+                if (a.limb[i] != b.limb[i]) return a.limb[i] < b.limb[i];
+            }
+            return false;
+        }
+
+        friend bool operator>(const uint256 &a, const uint256 &b) { return b < a; }
+
+        friend bool operator<=(const uint256 &a, const uint256 &b) { return !(b < a); }
+
+        friend bool operator>=(const uint256 &a, const uint256 &b) { return !(a < b); }
+
+        /** \brief 10^n, zero past 10^77 which does not fit */
+        static uint256 pow10(int n) {
+            uint256 r(1);
+            if (n > 77) return uint256();
+            for (; n >= 19; n -= 19) r *= uint256(10000000000000000000ULL);
+            uint64_t tail = 1;
+            for (; n > 0; n--) tail *= 10;
+            return r * uint256(tail);
+        }
+
+        /** \brief Parse a decimal number in token units, e.g. "1234.5" or "1.5e-7", into the smallest unit
+         * \param str the number
+         * \param length its length
+         * \param decimals decimals of the token
+         * \param out set to the amount in the smallest unit, digits below it truncated
+         * \return false if the number is negative, malformed or does not fit
+         */
+        static bool fromDecimal(const char *str, size_t length, int decimals, uint256 &out) {
+            uint256 digits;
+            int fraction = 0;
+            int significant = 0;
+            bool point = false;
+            bool any = false;
+            size_t i = 0;
+            for (; i < length; i++) {
+                char c = str[i];
+                if (c == '.' && !point) {
+                    point = true;
+                } else if (c >= '0' && c <= '9') {
+                    any = true;
+                    if (significant == 0 && c == '0' && !point) continue;
+                    if (significant >= 77) return false;
+                    if (significant > 0 || c != '0') significant++;
+                    digits = digits * uint256(10) + uint256(static_cast<uint64_t>(c - '0'));
+                    if (point) fraction++;
+                } else {
+                    break;
+                }
+            }
+            if (!any) return false;
+
+            int exponent = 0;
+            if (i < length && (str[i] == 'e' || str[i] == 'E')) {
+                try {
+                    size_t used = 0;
+                    exponent = std::stoi(std::string(str + i + 1, length - i - 1), &used);
+                    if (used != length - i - 1) return false;
+                } catch (const std::exception &) {
+                    return false;
+                }
+            } else if (i < length) {
+                return false;
+            }
+
+            long scale = static_cast<long>(decimals) - fraction + exponent;
+            if (scale >= 0) {
+                if (digits.isZero()) {
+                    out = digits;
+                    return true;
+                }
+                if (scale > 77 || significant + scale > 78) return false;
+                uint256 factor = pow10(static_cast<int>(scale));
+                out = digits * factor;
+                if (out / factor != digits) return false;
+            } else {
+                out = scale < -77 ? uint256() : digits / pow10(static_cast<int>(-scale));
+            }
+            return true;
+        }
+
+        /** \brief Parse a big-endian hex number, "0x" prefixed or not, e.g. a word of EVM log data
+         * \param str the number
+         * \param length its length
+         * \param out set to the number
+         * \return false if the number is empty, malformed or longer than 64 digits
+         */
+        static bool fromHex(const char *str, size_t length, uint256 &out) {
+            if (length >= 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+                str += 2;
+                length -= 2;
+            }
+            if (length == 0 || length > 64) return false;
+            out = uint256();
+            for (size_t i = 0; i < length; i++) {
+                char c = str[i];
+                uint64_t digit;
+                if (c >= '0' && c <= '9') digit = c - '0';
+                else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+                else return false;
+                out <<= 4;
+                out.limb[0] |= digit;
+            }
+            return true;
+        }
+
+        /** \brief The integer part of a non-negative double, zero for NaN and negatives */
+        static uint256 fromDouble(double value) {
+            if (!(value >= 1.0)) return uint256();
+            int exponent;
+            double mantissa = std::frexp(value, &exponent);     // value = mantissa * 2^exponent
+            if (exponent > 256) return ~uint256();
+            uint256 r(static_cast<uint64_t>(std::ldexp(mantissa, 64 > exponent ? exponent : 64)));
+            if (exponent > 64) r <<= exponent - 64;
+            return r;
+        }
+
+        friend uint256 operator~(uint256 a) {
+            for (uint64_t &l : a.limb) l = ~l;
+            return a;
+        }
+
+        double toDouble() const {
+            return std::ldexp(static_cast<double>(limb[3]), 192) + std::ldexp(static_cast<double>(limb[2]), 128) +
+                   std::ldexp(static_cast<double>(limb[1]), 64) + static_cast<double>(limb[0]);
+        }
+
+        std::string toString() const {
+            if (isZero()) return "0";
+            std::string s;
+            uint256 v = *this, q, r;
+            const uint256 chunk(10000000000000000000ULL);
+            while (!v.isZero()) {
+                divmod(v, chunk, q, r);
+                std::string part = std::to_string(r.limb[0]);
+                if (!q.isZero()) part.insert(0, 19 - part.size(), '0');
+                s.insert(0, part);
+                v = q;
+            }
+            return s;
+        }
+    };
+}
@@ -0,0 +1,243 @@
+#include "market_graph.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+
+// Weight of an edge whose pool is no longer quoted, it never takes part in a cycle
+static constexpr double kInactive = std::numeric_limits<double>::infinity();
+
+MarketGraph::MarketGraph() {
+    digraph_ = std::make_unique<EdgeWeightedDigraph>(0);
+}
+
+double MarketGraph::edgeWeight(const Quotes &quote, bool zero_for_one) const {
+    // token1Price is the amount of token1 per token0, and the other way around
+    return zero_for_one
+           ? edgeWeight(quote.token1Price, quote.reserve0, quote.reserve1, quote.fee, quote.token0derivedETH,
+                        quote.token1derivedETH)
+           : edgeWeight(quote.token0Price, quote.reserve1, quote.reserve0, quote.fee, quote.token1derivedETH,
+                        quote.token0derivedETH);
+}
+
+double MarketGraph::edgeWeight(double price, double reserve_in, double reserve_out, double fee,
+                               double derived_eth_in, double derived_eth_out) const {
+    if (!(notional_eth_ > 0.0)) return -std::log(price);
+
+    // A pool too thin for the notional gets a rate far below its mid price, so it no longer
+    // closes the phantom cycles the sizing would throw away. The subgraph leaves the thin tokens
+    // unpriced, their notional is then taken from the token bought
+    double amount_in = 0.0;
+    if (derived_eth_in > 0.0) {
+        amount_in = notional_eth_ / derived_eth_in;
+    } else if (derived_eth_out > 0.0 && price > 0.0) {
+        amount_in = notional_eth_ / (derived_eth_out * price);
+    }
+    if (reserve_in > 0.0 && reserve_out > 0.0 && amount_in > 0.0) {
+        return -std::log(SwapSimulator::getAmountOut(amount_in, reserve_in, reserve_out, fee) / amount_in);
+    }
+
+    // Neither token priced: the fee at least, never better than a pool that pays it
+    return -std::log(price * (1.0 - fee));
+}
+
+GraphDelta MarketGraph::apply(const std::vector<Quotes> &quotes) {
+    GraphDelta delta;
+    snapshot_++;
+
+    for (auto const &quote : quotes) {
+        uint32_t pool;
+        if (!assets_.findPool(quote.id, pool)) {
+            addPool(quote, delta);
+            continue;
+        }
+
+        seen_[pool] = snapshot_;
+        Pool &p = assets_.pool(pool);
+        assets_.asset(p.token0).derivedETH = quote.token0derivedETH;
+        assets_.asset(p.token1).derivedETH = quote.token1derivedETH;
+
+        // The reserves of the last Sync event are newer than the ones of the subgraph
+        if (synced_[pool] > 0) {
+            reprice(pool, delta);
+            continue;
+        }
+        p.reserve0 = quote.reserve0;
+        p.reserve1 = quote.reserve1;
+        p.reserve0Raw = quote.reserve0Raw;
+        p.reserve1Raw = quote.reserve1Raw;
+        for (bool zero_for_one : {true, false}) {
+            uint32_t id = edgeId(pool, zero_for_one);
+            double weight = edgeWeight(quote, zero_for_one);
+            if (edges_[id]->weight() != weight) {
+                setWeight(id, weight);
+                delta.updated.emplace_back(id);
+            }
+        }
+    }
+
+    // Pools the snapshot no longer quotes stay in the graph, but out of reach
+    for (uint32_t pool = 0; pool < seen_.size(); pool++) {
+        if (seen_[pool] == snapshot_) continue;
+        bool active = false;
+        for (bool zero_for_one : {true, false}) {
+            uint32_t id = edgeId(pool, zero_for_one);
+            if (edges_[id]->weight() != kInactive) {
+                setWeight(id, kInactive);
+                delta.updated.emplace_back(id);
+                active = true;
+            }
+        }
+        if (active) delta.deactivated++;
+    }
+
+    if (delta.structural()) csr_stale_ = true;
+    return delta;
+}
+
+bool MarketGraph::updateEdgeWeight(uint32_t pool, bool zero_for_one, double price) {
+    if (pool >= seen_.size()) return false;
+    const Pool &p = assets_.pool(pool);
+    double reserve_in = zero_for_one ? p.reserve0 : p.reserve1;
+    double reserve_out = zero_for_one ? p.reserve1 : p.reserve0;
+    double derived_eth_in = assets_.asset(zero_for_one ? p.token0 : p.token1).derivedETH;
+    double derived_eth_out = assets_.asset(zero_for_one ? p.token1 : p.token0).derivedETH;
+    uint32_t id = edgeId(pool, zero_for_one);
+    double weight = edgeWeight(price, reserve_in, reserve_out, p.fee, derived_eth_in, derived_eth_out);
+    if (edges_[id]->weight() == weight) return false;
+    setWeight(id, weight);
+    return true;
+}
+
+bool MarketGraph::findPool(const std::string &address, uint32_t &pool) const {
+    std::string key(address);
+    std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+    auto it = address_.find(key);
+    if (it == address_.end()) return false;
+    pool = it->second;
+    return true;
+}
+
+void MarketGraph::sync(uint32_t pool, const utils::uint256 &reserve0, const utils::uint256 &reserve1,
+                       uint64_t block, GraphDelta &delta) {
+    // Events of a block older than the last one applied are stale
+    if (pool >= synced_.size() || block < synced_[pool]) return;
+    synced_[pool] = std::max<uint64_t>(1, block);
+
+    Pool &p = assets_.pool(pool);
+    p.reserve0Raw = reserve0;
+    p.reserve1Raw = reserve1;
+    p.reserve0 = reserve0.toDouble() / std::pow(10.0, assets_.asset(p.token0).decimals);
+    p.reserve1 = reserve1.toDouble() / std::pow(10.0, assets_.asset(p.token1).decimals);
+    delta.synced++;
+
+    // A pool the snapshots dropped stays out of reach until they quote it again
+    if (seen_[pool] == snapshot_) reprice(pool, delta);
+}
+
+void MarketGraph::reprice(uint32_t pool, GraphDelta &delta) {
+    // The mid price of the reserves, as token0Price and token1Price of the subgraph
+    const Pool &p = assets_.pool(pool);
+    bool empty = !(p.reserve0 > 0.0 && p.reserve1 > 0.0);
+    for (bool zero_for_one : {true, false}) {
+        double price = empty ? 0.0 : zero_for_one ? p.reserve1 / p.reserve0 : p.reserve0 / p.reserve1;
+        if (updateEdgeWeight(pool, zero_for_one, price)) {
+            delta.updated.emplace_back(edgeId(pool, zero_for_one));
+        }
+    }
+}
+
+void MarketGraph::unsync() {
+    std::fill(synced_.begin(), synced_.end(), 0);
+}
+
+void MarketGraph::unsync(uint32_t pool) {
+    if (pool < synced_.size()) synced_[pool] = 0;
+}
+
+int MarketGraph::vertexOf(const std::string &address, GraphDelta &delta) {
+    auto it = vertex_.find(address);
+    if (it != vertex_.end()) return it->second;
+    int v = digraph_->addVertex();
+    vertex_.emplace(address, v);
+    delta.new_vertices++;
+    return v;
+}
+
+void MarketGraph::addPool(const Quotes &quote, GraphDelta &delta) {
+    Asset asset_0;
+    asset_0.symbol = quote.token0Symbol;
+    asset_0.address = quote.token0Address;
+    asset_0.decimals = quote.token0decimals;
+    asset_0.derivedETH = quote.token0derivedETH;
+
+    Asset asset_1;
+    asset_1.symbol = quote.token1Symbol;
+    asset_1.address = quote.token1Address;
+    asset_1.decimals = quote.token1decimals;
+    asset_1.derivedETH = quote.token1derivedETH;
+
+    Pool p;
+    p.quoteId = quote.id;
+    p.poolID = quote.poolID;
+    p.protocol = quote.protocol;
+    p.reserve0 = quote.reserve0;
+    p.reserve1 = quote.reserve1;
+    p.reserve0Raw = quote.reserve0Raw;
+    p.reserve1Raw = quote.reserve1Raw;
+    p.fee = quote.fee;
+    p.token0 = assets_.addAsset(quote.protocol, asset_0);
+    p.token1 = assets_.addAsset(quote.protocol, asset_1);
+    uint32_t pool = assets_.addPool(p);
+    seen_.emplace_back(snapshot_);
+    synced_.emplace_back(0);
+    std::string address(quote.poolID);
+    std::transform(address.begin(), address.end(), address.begin(), ::tolower);
+    address_.emplace(std::move(address), pool);
+
+    int v0 = vertexOf(quote.token0Address, delta);
+    int v1 = vertexOf(quote.token1Address, delta);
+
+    // edge ids follow pool ids: 2 * pool sells token1, 2 * pool + 1 sells token0
+    for (bool zero_for_one : {false, true}) {
+        DirectedEdge *e = zero_for_one
+                          ? arena_.create(v0, v1, edgeWeight(quote, true), pool, true)
+                          : arena_.create(v1, v0, edgeWeight(quote, false), pool, false);
+        digraph_->addEdge(e);
+        edges_.emplace_back(e);
+        slot_.emplace_back(-1);
+        delta.added.emplace_back(edgeId(pool, zero_for_one));
+    }
+}
+
+void MarketGraph::setWeight(uint32_t edge, double weight) {
+    edges_[edge]->setWeight(weight);
+    if (csr_ && slot_[edge] >= 0) csr_->setWeight(slot_[edge], weight);
+}
+
+const CsrDigraph &MarketGraph::csr() {
+    if (csr_stale_ || !csr_) {
+        csr_ = std::make_unique<CsrDigraph>(*digraph_);
+        for (int i = 0; i < csr_->E(); i++) {
+            const DirectedEdge *e = csr_->edge(i);
+            slot_[edgeId(e->pool(), e->zero_for_one())] = i;
+        }
+        csr_stale_ = false;
+    }
+    return *csr_;
+}
+
+void MarketGraph::clear() {
+    csr_.reset();
+    csr_stale_ = true;
+    digraph_ = std::make_unique<EdgeWeightedDigraph>(0);
+    arena_.reset();
+    assets_.clear();
+    slot_.clear();
+    edges_.clear();
+    seen_.clear();
+    synced_.clear();
+    vertex_.clear();
+    address_.clear();
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "quote_source.h"
+#include "swap_simulator.h"
+#include "libs/graph/directed_edge.h"
+#include "libs/graph/edge_arena.h"
+#include "libs/graph/asset_table.h"
+#include "libs/graph/edge_weighted_digraph.h"
+#include "libs/graph/csr_digraph.h"
+
+// What a snapshot changed in the market graph. Edges are named by id, see MarketGraph::edgeId
+struct GraphDelta {
+    std::vector<uint32_t> updated;      // edges repriced, deactivated ones included
+    std::vector<uint32_t> added;        // edges of pools seen for the first time
+    int new_vertices = 0;               // tokens seen for the first time
+    int deactivated = 0;                // pools missing from the snapshot
+    int synced = 0;                     // pools repriced from the reserves of a Sync event
+
+    bool structural() const { return new_vertices > 0 || !added.empty(); }
+
+    bool empty() const { return updated.empty() && !structural(); }
+};
+
+// Market graph kept across cycles: a vertex per token address, two edges per pool.
+// Snapshots only reprice the pools that moved and insert the pools never seen before,
+// so maintaining the graph costs O(changed pools) instead of a full rebuild.
+class MarketGraph {
+private:
+    EdgeArena arena_;
+    AssetTable assets_;
+    std::unique_ptr<EdgeWeightedDigraph> digraph_;
+    std::unique_ptr<CsrDigraph> csr_;                   // frozen copy for the searches
+    bool csr_stale_ = true;                             // structure changed since the freeze
+    std::vector<int> slot_;                             // slot_[edge id] = CSR slot of the edge
+    std::vector<DirectedEdge *> edges_;                 // edges_[edge id] = edge
+    std::vector<uint64_t> seen_;                        // seen_[pool] = last snapshot quoting the pool
+    uint64_t snapshot_ = 0;
+    double notional_eth_ = 0.0;                         // trade size the edges are weighted at, see edgeWeight
+    std::vector<uint64_t> synced_;                      // synced_[pool] = block of its last Sync event, 0 if none
+    std::unordered_map<std::string, int> vertex_;       // token address -> vertex
+    std::unordered_map<std::string, uint32_t> address_; // lower case pool address -> pool
+
+    // Vertex of a token address, added on first sight
+    int vertexOf(const std::string &address, GraphDelta &delta);
+
+    // Intern the pool of a quote and create both of its edges
+    void addPool(const Quotes &quote, GraphDelta &delta);
+
+    // Reprice both edges of a pool from its reserves
+    void reprice(uint32_t pool, GraphDelta &delta);
+
+    // Set the weight of an edge on the adjacency lists and on the frozen copy
+    void setWeight(uint32_t edge, double weight);
+
+public:
+    MarketGraph();
+
+    // Id of the edge selling token0 (zero_for_one) or token1 of a pool
+    static uint32_t edgeId(uint32_t pool, bool zero_for_one) { return pool * 2 + (zero_for_one ? 1 : 0); }
+
+    // Weight of the edge selling token0 (zero_for_one) or token1 of a quoted pool
+    double edgeWeight(const Quotes &quote, bool zero_for_one) const;
+
+    // Weight of an edge at price, the amount of the bought token per sold token, or with a notional
+    // set, at the rate a trade of that size gets from the reserves once the fee and price impact are paid.
+    // derived_eth_in and derived_eth_out are the ETH prices of the sold and bought tokens
+    double edgeWeight(double price, double reserve_in, double reserve_out, double fee, double derived_eth_in,
+                      double derived_eth_out) const;
+
+    // Size, in ETH, of the trade the edges are weighted at, 0 for the mid price.
+    // Takes effect as the pools are repriced
+    void setNotional(double eth) { notional_eth_ = eth; }
+
+    double notional() const { return notional_eth_; }
+
+    // Merge a full snapshot of quotes: reprice known pools, insert new ones,
+    // and deactivate the pools the snapshot no longer quotes
+    GraphDelta apply(const std::vector<Quotes> &quotes);
+
+    // Reprice one direction of a pool, price being the amount of the bought token per sold token,
+    // weighted as edgeWeight does with the reserves and fee of the pool.
+    // Returns false if the pool is unknown or the weight did not change
+    bool updateEdgeWeight(uint32_t pool, bool zero_for_one, double price);
+
+    // Pool of a pair address, in any case
+    bool findPool(const std::string &address, uint32_t &pool) const;
+
+    // Set the reserves of a pool from a Sync event and reprice both of its edges. The pool keeps
+    // these reserves over the ones of the snapshots, which lag the chain, until unsync()
+    void sync(uint32_t pool, const utils::uint256 &reserve0, const utils::uint256 &reserve1, uint64_t block,
+              GraphDelta &delta);
+
+    // Give the pools back to the snapshots, when Sync events may have been missed
+    void unsync();
+
+    // Give one pool back to the snapshots, when its last Sync event was reverted
+    void unsync(uint32_t pool);
+
+    // Forget every token and pool
+    void clear();
+
+    const EdgeWeightedDigraph &digraph() const { return *digraph_; }
+
+    // Frozen copy of the graph, refrozen only when its structure changed
+    const CsrDigraph &csr();
+
+    const AssetTable &assets() const { return assets_; }
+
+    DirectedEdge *edge(uint32_t id) const { return edges_[id]; }
+
+    // Slot of an edge in the frozen copy, valid once csr() has been called
+    int slot(uint32_t id) const { return slot_[id]; }
+
+    int V() const { return digraph_->V(); }
+
+    int E() const { return digraph_->E(); }
+};
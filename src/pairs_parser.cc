@@ -0,0 +1,316 @@
+#include "pairs_parser.h"
+
+#include <charconv>
+#include <cstring>
+#include <spdlog/spdlog.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/error/en.h>
+
+namespace {
+
+    // SAX handler following {"data": {"pairs": [{..., "token0": {...}, "token1": {...}}, ...]}}
+    class PairsHandler {
+    public:
+        PairsHandler(const std::string &protocol, bool skip_unnamed_pairs,
+                     std::vector<Quotes> &buffer, PairsPage &page) :
+                protocol_(protocol), skip_unnamed_pairs_(skip_unnamed_pairs), buffer_(buffer), page_(page) {
+            frames_.reserve(8);
+        }
+
+        bool pairsSeen() const { return pairs_seen_; }
+
+        bool StartObject() {
+            Frame parent = frames_.empty() ? Frame::None : frames_.back();
+            Frame frame = Frame::Other;
+            if (parent == Frame::None) {
+                frame = Frame::Root;
+            } else if (parent == Frame::Root && key_ == Field::Data) {
+                frame = Frame::Data;
+            } else if (parent == Frame::Pairs) {
+                frame = Frame::Pair;
+                quote_ = Quotes{};
+                quote_.protocol = protocol_;
+                reserve0_.clear();
+                reserve1_.clear();
+            } else if (parent == Frame::Pair && key_ == Field::Token0) {
+                frame = Frame::Token0;
+            } else if (parent == Frame::Pair && key_ == Field::Token1) {
+                frame = Frame::Token1;
+            }
+            frames_.push_back(frame);
+            key_ = Field::Other;
+            return true;
+        }
+
+        bool EndObject(rapidjson::SizeType) {
+            Frame frame = frames_.back();
+            frames_.pop_back();
+            key_ = Field::Other;
+            if (frame == Frame::Pair) return endPair();
+            return true;
+        }
+
+        bool StartArray() {
+            Frame parent = frames_.empty() ? Frame::None : frames_.back();
+            if (parent == Frame::Data && key_ == Field::Pairs) {
+                frames_.push_back(Frame::Pairs);
+                pairs_seen_ = true;
+            } else {
+                frames_.push_back(Frame::Other);
+            }
+            key_ = Field::Other;
+            return true;
+        }
+
+        bool EndArray(rapidjson::SizeType) {
+            frames_.pop_back();
+            key_ = Field::Other;
+            return true;
+        }
+
+        bool Key(const char *str, rapidjson::SizeType length, bool) {
+            key_ = keyOf(str, length);
+            return true;
+        }
+
+        bool String(const char *str, rapidjson::SizeType length, bool) {
+            if (frames_.empty()) return true;
+            switch (frames_.back()) {
+                case Frame::Pair:
+                    return pairField(str, length);
+                case Frame::Token0:
+                    return tokenField(str, length, quote_.token0Address, quote_.token0Symbol,
+                                      quote_.token0decimals, quote_.token0derivedETH);
+                case Frame::Token1:
+                    return tokenField(str, length, quote_.token1Address, quote_.token1Symbol,
+                                      quote_.token1decimals, quote_.token1derivedETH);
+                default:
+                    return true;
+            }
+        }
+
+        // The subgraph sends every number as a string, plain numbers are not used by the pairs
+        bool RawNumber(const char *, rapidjson::SizeType, bool) { return true; }
+
+        bool Null() { return true; }
+
+        bool Bool(bool) { return true; }
+
+        bool Int(int) { return true; }
+
+        bool Uint(unsigned) { return true; }
+
+        bool Int64(int64_t) { return true; }
+
+        bool Uint64(uint64_t) { return true; }
+
+        bool Double(double) { return true; }
+
+    private:
+        enum class Frame {
+            None, Root, Data, Pairs, Pair, Token0, Token1, Other
+        };
+
+        enum class Field {
+            Data, Pairs, Id, Token0, Token1, Symbol, Decimals, DerivedETH, Token0Price, Token1Price, Reserve0, Reserve1,
+            Other
+        };
+
+        static Field keyOf(const char *str, rapidjson::SizeType length) {
+            auto is = [str, length](const char *name) {
+                return std::strlen(name) == length && std::memcmp(str, name, length) == 0;
+            };
+            if (is("id")) return Field::Id;
+            if (is("token0")) return Field::Token0;
+            if (is("token1")) return Field::Token1;
+            if (is("symbol")) return Field::Symbol;
+            if (is("decimals")) return Field::Decimals;
+            if (is("derivedETH")) return Field::DerivedETH;
+            if (is("token0Price")) return Field::Token0Price;
+            if (is("token1Price")) return Field::Token1Price;
+            if (is("reserve0")) return Field::Reserve0;
+            if (is("reserve1")) return Field::Reserve1;
+            if (is("pairs")) return Field::Pairs;
+            if (is("data")) return Field::Data;
+            return Field::Other;
+        }
+
+        template<typename T>
+        bool number(const char *str, rapidjson::SizeType length, T &value) {
+            auto[end, ec] = std::from_chars(str, str + length, value);
+            if (ec != std::errc() || end != str + length) {
+                page_.error = "invalid number " + std::string(str, length) + " in pair " + quote_.poolID;
+                return false;
+            }
+            return true;
+        }
+
+        bool pairField(const char *str, rapidjson::SizeType length) {
+            switch (key_) {
+                case Field::Id:
+                    quote_.poolID.assign(str, length);
+                    return true;
+                case Field::Token0Price:
+                    return number(str, length, quote_.token0Price);
+                case Field::Token1Price:
+                    return number(str, length, quote_.token1Price);
+                case Field::Reserve0:
+                    reserve0_.assign(str, length);
+                    return number(str, length, quote_.reserve0);
+                case Field::Reserve1:
+                    reserve1_.assign(str, length);
+                    return number(str, length, quote_.reserve1);
+                default:
+                    return true;
+            }
+        }
+
+        bool tokenField(const char *str, rapidjson::SizeType length, std::string &address, std::string &symbol,
+                        int64_t &decimals, double &derivedETH) {
+            switch (key_) {
+                case Field::Id:
+                    address.assign(str, length);
+                    return true;
+                case Field::Symbol:
+                    symbol.assign(str, length);
+                    return true;
+                case Field::Decimals:
+                    return number(str, length, decimals);
+                case Field::DerivedETH:
+                    return number(str, length, derivedETH);
+                default:
+                    return true;
+            }
+        }
+
+        bool endPair() {
+            page_.pairs++;
+            page_.cursor = quote_.poolID;
+            if (skip_unnamed_pairs_ && (quote_.token0Symbol.empty() || quote_.token1Symbol.empty())) {
+                spdlog::warn("{} problem with pair: {} {}/{}", protocol_, quote_.poolID, quote_.token0Address,
+                             quote_.token1Address);
+                return true;
+            }
+            // The decimals of the tokens may come after the reserves, scale them once the pair is complete.
+            // A reserve that cannot be scaled stays zero and the pool is left out of the exact replay
+            if (!utils::uint256::fromDecimal(reserve0_.data(), reserve0_.size(), quote_.token0decimals,
+                                             quote_.reserve0Raw) ||
+                !utils::uint256::fromDecimal(reserve1_.data(), reserve1_.size(), quote_.token1decimals,
+                                             quote_.reserve1Raw)) {
+                quote_.reserve0Raw = quote_.reserve1Raw = utils::uint256();
+            }
+            // Unique ID, stable across cycles
+            quote_.id = quote_.protocol + "_" + quote_.poolID;
+            buffer_.emplace_back(std::move(quote_));
+            return true;
+        }
+
+    private:
+        const std::string &protocol_;
+        bool skip_unnamed_pairs_;
+        std::vector<Quotes> &buffer_;
+        PairsPage &page_;
+        std::vector<Frame> frames_;     // objects and arrays currently open
+        Field key_ = Field::Other;          // last key read in the innermost object
+        Quotes quote_{};                // pair being read
+        std::string reserve0_;          // reserves of the pair as sent, in token units
+        std::string reserve1_;
+        bool pairs_seen_ = false;
+    };
+}
+
+bool parsePairs(const char *json, const std::string &protocol, bool skip_unnamed_pairs,
+                std::vector<Quotes> &buffer, PairsPage &page) {
+    PairsHandler handler(protocol, skip_unnamed_pairs, buffer, page);
+    rapidjson::Reader reader;
+    rapidjson::StringStream stream(json);
+    rapidjson::ParseResult result = reader.Parse<rapidjson::kParseNumbersAsStringsFlag>(stream, handler);
+    if (result.IsError()) {
+        if (page.error.empty()) {
+            page.error = std::string(rapidjson::GetParseError_En(result.Code())) + " at offset " +
+                         std::to_string(result.Offset());
+        }
+        return false;
+    }
+    if (!handler.pairsSeen()) {
+        page.error = "No data";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Parse throughput of the SAX path against the rapidjson DOM walk it replaced,
+ * over a recorded subgraph response.
+ *
+ * Compilation:  clang++ -O2 -DDebug pairs_parser.cc -std=c++17 -lspdlog -lfmt -lssl -lcrypto -lpthread -o pairs_parser
+ * Execution:    ./pairs_parser response.json [rounds]
+ */
+#ifdef Debug
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <rapidjson/document.h>
+
+// The DOM walk of the original loaders, kept for comparison only
+static size_t parsePairsDom(const std::string &body, std::vector<Quotes> &buffer) {
+    rapidjson::Document document;
+    if (document.Parse(body.c_str()).HasParseError()) return 0;
+    const rapidjson::Value &pairs = document["data"]["pairs"];
+    for (rapidjson::SizeType i = 0; i < pairs.Size(); i++) {
+        Quotes quote;
+        quote.protocol = "UNISWAP";
+        quote.poolID = pairs[i]["id"].GetString();
+        quote.id = quote.protocol + "_" + quote.poolID;
+        quote.token0Symbol = pairs[i]["token0"]["symbol"].GetString();
+        quote.token0decimals = std::stoi(pairs[i]["token0"]["decimals"].GetString());
+        quote.token0Address = pairs[i]["token0"]["id"].GetString();
+        quote.token0Price = std::stod(pairs[i]["token0Price"].GetString());
+        quote.token0derivedETH = std::stod(pairs[i]["token0"]["derivedETH"].GetString());
+        quote.token1Symbol = pairs[i]["token1"]["symbol"].GetString();
+        quote.token1decimals = std::stoi(pairs[i]["token1"]["decimals"].GetString());
+        quote.token1Address = pairs[i]["token1"]["id"].GetString();
+        quote.token1Price = std::stod(pairs[i]["token1Price"].GetString());
+        quote.token1derivedETH = std::stod(pairs[i]["token1"]["derivedETH"].GetString());
+        quote.reserve0 = std::stod(pairs[i]["reserve0"].GetString());
+        quote.reserve1 = std::stod(pairs[i]["reserve1"].GetString());
+        buffer.emplace_back(std::move(quote));
+    }
+    return pairs.Size();
+}
+
+int main(int argc, char *argv[]) {
+    std::ifstream in(argv[1]);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string body = ss.str();
+    int rounds = argc > 2 ? std::stoi(argv[2]) : 100;
+    double megabytes = body.size() * static_cast<double>(rounds) / (1024 * 1024);
+
+    std::vector<Quotes> buffer;
+    size_t pairs = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        buffer.clear();
+        pairs = parsePairsDom(body, buffer);
+    }
+    double dom = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("DOM : %zu pairs  %8.2f MB/s\n", pairs, megabytes / dom);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        buffer.clear();
+        PairsPage page;
+        if (!parsePairs(body.c_str(), "UNISWAP", false, buffer, page)) {
+            printf("SAX : %s\n", page.error.c_str());
+            return 1;
+        }
+        pairs = page.pairs;
+    }
+    double sax = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("SAX : %zu pairs  %8.2f MB/s\n", pairs, megabytes / sax);
+
+    return 0;
+}
+#endif
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "quote_source.h"
+
+// Outcome of parsing one page of pairs
+struct PairsPage {
+    size_t pairs = 0;       // pair objects in the page, skipped ones included
+    std::string cursor;     // id of the last pair of the page
+    std::string error;      // why the page was rejected
+};
+
+// Parse a subgraph pairs response in a single pass, without building a DOM, appending a quote per pair
+bool parsePairs(const char *json, const std::string &protocol, bool skip_unnamed_pairs,
+                std::vector<Quotes> &buffer, PairsPage &page);
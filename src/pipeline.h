@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stack>
+#include <string>
+#include <vector>
+#include "libs/misc/blockingconcurrentqueue.h"
+#include "quote_source.h"
+#include "market_graph.h"
+
+// Stages a snapshot goes through, each on its own thread
+enum class Stage {
+    Ingest,     // fetch the pairs of every source
+    Graph,      // patch the market graph with the snapshot
+    Detect,     // search the negative cycles
+    Size,       // format, dedup and size the candidates against the reserves
+    Execute,    // confirm with the node and send the trade
+};
+
+constexpr size_t kStages = 5;
+
+inline const char *stageName(Stage stage) {
+    static const char *names[kStages] = {"ingest", "graph", "detect", "size", "execute"};
+    return names[static_cast<size_t>(stage)];
+}
+
+struct Arbitrage {
+    std::string currency_return;
+    int64_t decimal_base;
+    double derivedETH;
+    std::vector<std::string> addr;
+    std::vector<std::string> exchange;
+    std::vector<std::string> pool;
+    std::string output;
+    double amount_in = 0.0;     // input of the best simulated profit, in currency_return
+    double profit = 0.0;        // simulated profit, in currency_return
+};
+
+// One snapshot on its way through the pipeline. Stages hand it over by moving it
+// from one queue to the next, so only one of them touches it at a time
+struct PipelineJob {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t id = 0;
+    std::vector<Quotes> quotes;
+    bool snapshot = false;                      // quotes hold a full snapshot of the subgraphs
+    bool unsync = false;                        // Sync logs were interrupted, the snapshot takes the pools back
+    GraphDelta delta;
+    std::vector<std::stack<DirectedEdge *>> cycles;
+    std::vector<Arbitrage> arbitrages;
+
+    Clock::time_point created;                  // ingest started
+    Clock::time_point queued;                   // entered its current queue
+    std::array<int64_t, kStages> busy_us{};     // time spent in each stage
+    std::array<int64_t, kStages> wait_us{};     // time queued before each stage
+    std::array<size_t, kStages> depth{};        // depth of the queue of each stage when it entered it
+};
+
+using JobQueue = moodycamel::BlockingConcurrentQueue<std::unique_ptr<PipelineJob>>;
+
+// Running totals of one stage, updated by its thread, read by the report
+struct StageStats {
+    std::atomic<uint64_t> jobs{0};
+    std::atomic<int64_t> busy_us{0};
+    std::atomic<int64_t> wait_us{0};
+    std::atomic<int64_t> max_busy_us{0};
+    std::atomic<size_t> max_depth{0};
+
+    void record(int64_t busy, int64_t wait, size_t queue_depth) {
+        jobs++;
+        busy_us += busy;
+        wait_us += wait;
+        if (busy > max_busy_us) max_busy_us = busy;
+        if (queue_depth > max_depth) max_depth = queue_depth;
+    }
+};
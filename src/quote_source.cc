@@ -0,0 +1,135 @@
+#include "quote_source.h"
+
+#include <algorithm>
+#include <future>
+#include <spdlog/spdlog.h>
+#include "libs/misc/elapsed.h"
+#include "pairs_parser.h"
+
+SubgraphSource::SubgraphSource(QuoteSource config) : config_(std::move(config)) {
+    config_.shards = std::clamp(config_.shards, 1, 16);
+    config_.page_size = std::clamp(config_.page_size, 1, 1000);
+    for (int i = 0; i < config_.shards; i++) {
+        auto client = std::make_unique<httplib::SSLClient>(
+                config_.host, 443
+        );
+        client->set_connection_timeout(30);
+        clients_.emplace_back(std::move(client));
+    }
+}
+
+bool SubgraphSource::load(std::vector<Quotes> &buffer) {
+    Elapsed elapsed(config_.name + " quotes");
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config_.deadline_ms);
+
+    // Every shard walks its own slice of the id space into its own buffer
+    std::vector<std::vector<Quotes>> buffers(config_.shards);
+    std::vector<std::vector<PageStats>> stats(config_.shards);
+    std::vector<std::future<bool>> shards;
+    for (int i = 0; i < config_.shards; i++) {
+        shards.emplace_back(std::async(std::launch::async, [this, i, deadline, &buffers, &stats]() {
+            return loadShard(i, deadline, buffers[i], stats[i]);
+        }));
+    }
+
+    bool loaded = true;
+    for (auto &shard : shards) {
+        loaded = shard.get() && loaded;
+    }
+
+    stats_.clear();
+    size_t bytes = 0;
+    int64_t slowest_us = 0;
+    for (int i = 0; i < config_.shards; i++) {
+        buffer.insert(buffer.end(), std::make_move_iterator(buffers[i].begin()),
+                      std::make_move_iterator(buffers[i].end()));
+        for (auto const &page : stats[i]) {
+            bytes += page.bytes;
+            slowest_us = std::max(slowest_us, page.latency_us);
+            stats_.emplace_back(page);
+        }
+    }
+    spdlog::info("{} subgraph: {} pairs in {} pages, {} bytes, slowest page {} ms", config_.name,
+                 buffer.size(), stats_.size(), bytes, slowest_us / 1000);
+
+    if (!loaded) return false;
+    if (buffer.empty()) {
+        spdlog::warn("No quotes for {}", config_.name);
+        return false;
+    }
+    return true;
+}
+
+bool SubgraphSource::loadShard(int shard, std::chrono::steady_clock::time_point deadline,
+                               std::vector<Quotes> &buffer, std::vector<PageStats> &stats) {
+    static const char *digits = "0123456789abcdef";
+
+    // Shard i covers the ids starting with the hex digits [16 * i / n, 16 * (i + 1) / n)
+    int first = 16 * shard / config_.shards;
+    int last = 16 * (shard + 1) / config_.shards;
+    std::string cursor = std::string("0x") + digits[first];
+    std::string upper;
+    if (last < 16) {
+        upper.append(R"(id_lt: \")").append("0x").append(1, digits[last]).append(R"(\", )");
+    }
+
+    for (int page = 0; page < config_.max_pages; page++) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            spdlog::warn("{} subgraph shard {} out of time after {} pages, tail dropped", config_.name, shard, page);
+            return true;
+        }
+
+        std::string data;
+        data.append(R"({ "query": "{ pairs(first: )").append(std::to_string(config_.page_size))
+                .append(R"(, where: {id_gt: \")").append(cursor).append(R"(\", )").append(upper)
+                .append(config_.where)
+                .append(R"(}, orderBy: id, orderDirection: asc) { )").append(config_.fields)
+                .append(R"( } }"})");
+
+        auto sent = std::chrono::steady_clock::now();
+        auto res = clients_[shard]->Post(config_.url.c_str(), data, "application/json");
+        if (res == nullptr) {
+            spdlog::error("{} subgraph error: {}", config_.name, "nullptr");
+            return false;
+        }
+
+        if (res.error()) {
+            spdlog::error("{} subgraph error: {}", config_.name, res.error());
+            return false;
+        }
+        auto received = std::chrono::steady_clock::now();
+
+        int pairs = parsePage(res->body, buffer, cursor);
+        if (pairs < 0) return false;
+        auto parsed = std::chrono::steady_clock::now();
+
+        PageStats page_stats{};
+        page_stats.shard = shard;
+        page_stats.page = page;
+        page_stats.bytes = res->body.size();
+        page_stats.pairs = pairs;
+        page_stats.latency_us = std::chrono::duration_cast<std::chrono::microseconds>(received - sent).count();
+        page_stats.parse_us = std::chrono::duration_cast<std::chrono::microseconds>(parsed - received).count();
+        stats.emplace_back(page_stats);
+        spdlog::debug("{} subgraph shard {} page {}: {} pairs, {} bytes, {} us fetch, {} us parse", config_.name,
+                      shard, page, page_stats.pairs, page_stats.bytes, page_stats.latency_us, page_stats.parse_us);
+
+        // A short page is the last one of the shard
+        if (pairs < config_.page_size) return true;
+    }
+
+    spdlog::warn("{} subgraph shard {} stopped at {} pages, tail dropped", config_.name, shard, config_.max_pages);
+    return true;
+}
+
+int SubgraphSource::parsePage(const std::string &body, std::vector<Quotes> &buffer, std::string &cursor) {
+    PairsPage page;
+    size_t first = buffer.size();
+    if (!parsePairs(body.c_str(), config_.protocol, config_.skip_unnamed_pairs, buffer, page)) {
+        spdlog::error("{} subgraph document parse error: {}: {}", config_.name, page.error, body.c_str());
+        return -1;
+    }
+    for (size_t i = first; i < buffer.size(); i++) buffer[i].fee = config_.fee;
+    if (!page.cursor.empty()) cursor = page.cursor;
+    return static_cast<int>(page.pairs);
+}
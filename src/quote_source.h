@@ -0,0 +1,83 @@
+#pragma once
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT 1
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "libs/misc/httplib.h"
+#include "libs/misc/uint256.h"
+
+struct Quotes {
+    std::string id;
+    std::string protocol;
+    std::string poolID;
+    std::string token0Symbol;
+    std::string token1Symbol;
+    std::string token0Address;
+    std::string token1Address;
+    int64_t token0decimals;
+    int64_t token1decimals;
+    double token0Price;
+    double token1Price;
+    double token0derivedETH;
+    double token1derivedETH;
+    double reserve0;
+    double reserve1;
+    utils::uint256 reserve0Raw;         // reserves in the smallest unit of the tokens, as on chain
+    utils::uint256 reserve1Raw;
+    double fee;                         // swap fee of the pool, from its source
+};
+
+// Where and how to fetch the pairs of one DEX
+struct QuoteSource {
+    std::string name;                   // used in logs
+    std::string protocol;               // tag of the quotes, e.g. UNISWAP
+    std::string host;                   // subgraph host
+    std::string url;                    // subgraph path
+    std::string where;                  // GraphQL filter on pairs, without the cursor
+    std::string fields;                 // GraphQL selection of a pair, must include id
+    bool skip_unnamed_pairs = false;    // drop pairs with an empty token symbol
+    int page_size = 1000;               // pairs per page, the subgraph caps it at 1000
+    int shards = 4;                     // id ranges walked concurrently, 1 to 16
+    int max_pages = 100;                // pages per shard before giving up on the tail
+    int64_t deadline_ms = 20000;        // time budget of a whole load
+    double fee = 0.003;                 // swap fee of every pool of the DEX
+};
+
+// Timing of one page of pairs
+struct PageStats {
+    int shard;
+    int page;
+    size_t bytes;
+    size_t pairs;
+    int64_t latency_us;                 // request sent to body received
+    int64_t parse_us;
+};
+
+// A quote source walking the pairs with id_gt cursors. The id space is split in shards,
+// each walked on its own connection, so pages are requested while others are parsed.
+class SubgraphSource {
+private:
+    QuoteSource config_;
+    std::vector<std::unique_ptr<httplib::SSLClient>> clients_;  // one per shard
+    std::vector<PageStats> stats_;                              // pages of the last load
+
+    // Walk the pages of one shard, parsing each as it arrives
+    bool loadShard(int shard, std::chrono::steady_clock::time_point deadline,
+                   std::vector<Quotes> &buffer, std::vector<PageStats> &stats);
+
+    // Parse a page into the buffer, returns the number of pairs in the page (or -1) and the last id
+    int parsePage(const std::string &body, std::vector<Quotes> &buffer, std::string &cursor);
+
+public:
+    explicit SubgraphSource(QuoteSource config);
+
+    const QuoteSource &config() const { return config_; }
+
+    const std::vector<PageStats> &stats() const { return stats_; }
+
+    // Fetch the pairs of the source and append them to the buffer
+    bool load(std::vector<Quotes> &buffer);
+};
@@ -0,0 +1,129 @@
+#include "scheduler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include <spdlog/spdlog.h>
+#include <rapidjson/document.h>
+
+const char *triggerName(Trigger trigger) {
+    switch (trigger) {
+        case Trigger::NewBlock:
+            return "block";
+        case Trigger::Drain:
+            return "drain";
+        default:
+            return "fixed";
+    }
+}
+
+Scheduler::Scheduler(ScheduleConfig config, std::function<bool()> drained)
+        : config_(std::move(config)), drained_(std::move(drained)) {
+    config_.period_ms = std::max<int64_t>(1, config_.period_ms);
+    config_.poll_ms = std::max<int64_t>(1, config_.poll_ms);
+    if (config_.trigger == Trigger::NewBlock) {
+        rpc_ = std::make_unique<httplib::Client>(config_.rpc_host, config_.rpc_port);
+        rpc_->set_connection_timeout(5);
+        rpc_->set_keep_alive(true);
+    }
+}
+
+uint64_t Scheduler::wait() {
+    uint64_t missed;
+    switch (config_.trigger) {
+        case Trigger::NewBlock:
+            missed = waitNewBlock();
+            break;
+        case Trigger::Drain:
+            missed = waitDrain();
+            break;
+        default:
+            missed = waitFixedRate();
+    }
+    started_ = true;
+    coalesced_ += missed;
+    return missed;
+}
+
+uint64_t Scheduler::waitFixedRate() {
+    const auto period = std::chrono::milliseconds(config_.period_ms);
+    if (!started_) {
+        next_ = Clock::now();
+        return 0;
+    }
+
+    // The due times stay on the grid of the first check, whatever the checks took
+    next_ += period;
+    auto now = Clock::now();
+    if (now < next_) {
+        std::this_thread::sleep_until(next_);
+        return 0;
+    }
+
+    // Late: run now in place of every tick that went by during the last check
+    auto missed = static_cast<uint64_t>((now - next_) / period);
+    next_ += missed * period;
+    return missed;
+}
+
+uint64_t Scheduler::waitNewBlock() {
+    const auto poll = std::chrono::milliseconds(config_.poll_ms);
+    bool failing = false;
+    while (true) {
+        uint64_t number;
+        if (blockNumber(number)) {
+            if (failing) {
+                spdlog::info("Node {}:{} back at block {}", config_.rpc_host, config_.rpc_port, number);
+            }
+            failing = false;
+
+            // Blocks mined while the last check ran are covered by this one
+            if (number > block_) {
+                uint64_t missed = started_ && block_ > 0 ? number - block_ - 1 : 0;
+                block_ = number;
+                return missed;
+            }
+        } else if (!failing) {
+            spdlog::error("Node {}:{} did not return its block number, retrying every {} ms",
+                          config_.rpc_host, config_.rpc_port, config_.poll_ms);
+            failing = true;
+        }
+        std::this_thread::sleep_for(poll);
+    }
+}
+
+uint64_t Scheduler::waitDrain() {
+    if (!started_) {
+        next_ = Clock::now();
+        return 0;
+    }
+
+    // Checks are at least poll_ms apart, so a failing ingest does not spin on the subgraph
+    next_ += std::chrono::milliseconds(config_.poll_ms);
+    std::this_thread::sleep_until(next_);
+    while (drained_ && !drained_()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    next_ = Clock::now();
+    return 0;
+}
+
+bool Scheduler::blockNumber(uint64_t &number) {
+    auto res = rpc_->Post("/", R"({"jsonrpc":"2.0","id":1,"method":"eth_blockNumber","params":[]})",
+                          "application/json");
+    if (!res || res->status != 200) {
+        return false;
+    }
+
+    rapidjson::Document document;
+    if (document.Parse(res->body.c_str()).HasParseError() || !document.IsObject() ||
+        !document.HasMember("result") || !document["result"].IsString()) {
+        return false;
+    }
+
+    // Quantities are hex strings, "0x" prefixed
+    const char *hex = document["result"].GetString();
+    char *end = nullptr;
+    number = std::strtoull(hex, &end, 16);
+    return end != hex && *end == '\0';
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#define CPPHTTPLIB_OPENSSL_SUPPORT 1
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include "libs/misc/httplib.h"
+
+// What starts the next check
+enum class Trigger {
+    FixedRate,  // every period, measured from the first check so the checks do not drift
+    NewBlock,   // every new block reported by the node
+    Drain,      // as soon as the pipeline has taken the previous snapshot in
+};
+
+struct ScheduleConfig {
+    Trigger trigger = Trigger::FixedRate;
+    int64_t period_ms = 10000;          // period of the fixed rate
+    std::string rpc_host = "localhost"; // JSON-RPC endpoint polled for new blocks
+    int rpc_port = 8545;
+    int64_t poll_ms = 250;              // eth_blockNumber polling period, and drain polling floor
+};
+
+// Paces the checks. A check that starts late takes the place of the ones it missed
+// instead of running them back to back, so the snapshots never pile up behind a slow one.
+class Scheduler {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    ScheduleConfig config_;
+    std::function<bool()> drained_;     // the pipeline has room for another snapshot
+    std::unique_ptr<httplib::Client> rpc_;
+
+    bool started_ = false;
+    Clock::time_point next_;            // fixed rate: when the next check is due
+    uint64_t block_ = 0;                // last block the node reported
+    uint64_t coalesced_ = 0;            // ticks or blocks merged into a later check
+
+    uint64_t waitFixedRate();
+
+    uint64_t waitNewBlock();
+
+    uint64_t waitDrain();
+
+    // Ask the node for its latest block number
+    bool blockNumber(uint64_t &number);
+
+public:
+    Scheduler(ScheduleConfig config, std::function<bool()> drained);
+
+    const ScheduleConfig &config() const { return config_; }
+
+    // Block until the next check is due, returns the number of ticks merged into it
+    uint64_t wait();
+
+    uint64_t block() const { return block_; }
+
+    uint64_t coalesced() const { return coalesced_; }
+};
+
+const char *triggerName(Trigger trigger);
@@ -12,10 +12,28 @@ Streaming::Streaming() {
     nodeRequest_->set_connection_timeout(120);
 
     // The graph
-    graphRequest_ = std::make_unique<httplib::SSLClient>(
-            "api.thegraph.com", 443
-    );
-    graphRequest_->set_connection_timeout(30);
+    const std::string pairs_where = "reserveUSD_gt: 10000, volumeUSD_gt: 5000";
+    const std::string pairs_fields = "token0 { id symbol name decimals derivedETH } token1 { id symbol name decimals derivedETH } id reserve0 reserve1 token0Price token1Price reserveETH reserveUSD volumeUSD";
+
+    QuoteSource uniswap;
+    uniswap.name = "Uniswap";
+    uniswap.protocol = "UNISWAP";
+    uniswap.host = "api.thegraph.com";
+    uniswap.url = "/subgraphs/name/uniswap/uniswap-v2";
+    //uniswap.url = "/subgraphs/name/maurodelazeri/uniswapv2-kovan";
+    uniswap.where = pairs_where;
+    uniswap.fields = pairs_fields;
+    uniswap.skip_unnamed_pairs = true;
+    sources_.emplace_back(std::make_unique<SubgraphSource>(uniswap));
+
+    QuoteSource sushiswap;
+    sushiswap.name = "Sushiswap";
+    sushiswap.protocol = "SUSHISWAP";
+    sushiswap.host = "api.thegraph.com";
+    sushiswap.url = "/subgraphs/name/croco-finance/sushiswap";
+    sushiswap.where = pairs_where;
+    sushiswap.fields = pairs_fields;
+    sources_.emplace_back(std::make_unique<SubgraphSource>(sushiswap));
 }
 
 Streaming::~Streaming() {}
@@ -26,15 +44,165 @@ Streaming::~Streaming() {}
         spdlog::info("DEBUG MODE IS ENABLED");
     }
 
+    const std::string detection = utils::getEnvVar("CYCLE_DETECTION");
+    if (strcasecmp("per_source", detection.c_str()) == 0) {
+        detection_mode_ = DetectionMode::PerSource;
+    } else if (strcasecmp("incremental", detection.c_str()) == 0) {
+        detection_mode_ = DetectionMode::Incremental;
+    } else if (strcasecmp("tarjan", detection.c_str()) == 0) {
+        detection_mode_ = DetectionMode::Tarjan;
+    } else if (strcasecmp("bounded", detection.c_str()) == 0) {
+        detection_mode_ = DetectionMode::HopBounded;
+    }
+    spdlog::info("Cycle detection mode: {}",
+                 detection_mode_ == DetectionMode::PerSource ? "per_source" :
+                 detection_mode_ == DetectionMode::Incremental ? "incremental" :
+                 detection_mode_ == DetectionMode::Tarjan ? "tarjan" :
+                 detection_mode_ == DetectionMode::HopBounded ? "bounded" : "super_source");
+
+    const std::string hops = utils::getEnvVar("MAX_HOPS");
+    if (!hops.empty()) {
+        max_hops_ = std::min(4, std::max(2, std::stoi(hops)));
+    }
+    if (detection_mode_ == DetectionMode::HopBounded) {
+        spdlog::info("Routes of up to {} hops", max_hops_);
+    }
+
+    // Edges weighted at the rate of a NOTIONAL_ETH trade, fee and price impact paid, 0 for the mid price
+    const std::string notional = utils::getEnvVar("NOTIONAL_ETH");
+    market_.setNotional(notional.empty() ? 1.0 : std::max(0.0, std::stod(notional)));
+    if (market_.notional() > 0.0) {
+        spdlog::info("Edges weighted at a {} ETH trade", market_.notional());
+    } else {
+        spdlog::info("Edges weighted at the mid price");
+    }
+
+    const std::string top_k = utils::getEnvVar("TOP_K_CYCLES");
+    if (!top_k.empty()) {
+        top_k_ = std::max(0, std::stoi(top_k));
+    }
+    spdlog::info("Cycles simulated per check: {}", top_k_ > 0 ? std::to_string(top_k_) : "all");
+
+    // The node simulation only confirms the best candidate of the in-process one
+    const std::string confirm = utils::getEnvVar("SIMULATION_CONFIRM");
+    confirm_simulation_ = strcasecmp("false", confirm.c_str()) != 0;
+    spdlog::info("Node simulation of the chosen operation: {}", confirm_simulation_ ? "on" : "off");
+
+    // Candidates confirmed by the node, over SIMULATION_IN_FLIGHT persistent connections
+    const std::string in_flight = utils::getEnvVar("SIMULATION_IN_FLIGHT");
+    int connections = in_flight.empty() ? 8 : std::max(1, std::stoi(in_flight));
+    const std::string confirm_top = utils::getEnvVar("SIMULATION_CONFIRM_TOP");
+    confirm_top_ = confirm_top.empty() ? connections : std::max(1, std::stoi(confirm_top));
+    for (int i = 0; i < connections; i++) {
+        auto client = std::make_unique<httplib::Client>("bsc_swapper", 3000);
+        client->set_connection_timeout(120);
+        client->set_keep_alive(true);
+        simulation_clients_.emplace_back(std::move(client));
+    }
+    simulation_pool_ = std::make_unique<ThreadPool>(connections);
+    if (confirm_simulation_) {
+        spdlog::info("Node simulation of the best {} candidates, {} in flight", confirm_top_, connections);
+    }
+
+    // Graphs of every cycle, for cycle_detector_benchmark
+    graph_record_dir_ = utils::getEnvVar("GRAPH_RECORD_DIR");
+    if (!graph_record_dir_.empty()) {
+        spdlog::info("Recording graphs to {}", graph_record_dir_);
+    }
+
+    const std::string workers = utils::getEnvVar("DETECTION_WORKERS");
+    detection_workers_ = workers.empty() ? std::max(1u, std::thread::hardware_concurrency()) : std::stoi(workers);
+    detection_workers_ = std::max(1, detection_workers_);
+    detection_pool_ = std::make_unique<ThreadPool>(detection_workers_);
+    spdlog::info("Cycle detection workers: {}", detection_workers_);
+
 //    loadPancakeSwapPrices();
 //    rungWebServer();
 
-    while (true) {
-        runCycle();
+    // Reserves pushed by the node as Sync logs, the subgraphs then only snapshot every SYNC_SNAPSHOT_MS
+    SyncSource sync;
+    sync.host = utils::getEnvVar("SYNC_WS_HOST");
+    if (!sync.host.empty()) {
+        const std::string sync_port = utils::getEnvVar("SYNC_WS_PORT");
+        if (!sync_port.empty()) {
+            sync.port = std::stoi(sync_port);
+        }
+        const std::string sync_path = utils::getEnvVar("SYNC_WS_PATH");
+        if (!sync_path.empty()) {
+            sync.path = sync_path;
+        }
+        sync.tls = (strcasecmp("true", utils::getEnvVar("SYNC_WS_TLS").c_str()) == 0);
+        sync.record_file = utils::getEnvVar("SYNC_RECORD_FILE");
+        const std::string snapshot = utils::getEnvVar("SYNC_SNAPSHOT_MS");
+        if (!snapshot.empty()) {
+            sync_snapshot_ms_ = std::max<int64_t>(0, std::stoll(snapshot));
+        }
+        sync_subscriber_ = std::make_unique<SyncSubscriber>(sync, [this](SyncEvent &&event) {
+            sync_events_.enqueue(std::move(event));
+        }, [this]() {
+            sync_reset_ = true;
+        });
+        sync_subscriber_->start();
+        spdlog::info("Sync logs from {}:{}{}, subgraph snapshots every {} ms", sync.host, sync.port, sync.path,
+                     sync_snapshot_ms_);
+    }
+
+    serial_ = (strcasecmp("false", utils::getEnvVar("PIPELINE").c_str()) == 0);
+    spdlog::info("Stages: {}", serial_ ? "serial" : "pipelined");
+
+    // Checks on a fixed period, on every block of the node, or as fast as the pipeline takes them
+    ScheduleConfig schedule;
+    const std::string trigger = utils::getEnvVar("SCHEDULE");
+    if (strcasecmp("block", trigger.c_str()) == 0) {
+        schedule.trigger = Trigger::NewBlock;
+    } else if (strcasecmp("drain", trigger.c_str()) == 0) {
+        schedule.trigger = Trigger::Drain;
+    }
+    const std::string period = utils::getEnvVar("SCHEDULE_PERIOD_MS");
+    if (!period.empty()) {
+        schedule.period_ms = std::stoll(period);
+    }
+    const std::string rpc_host = utils::getEnvVar("NODE_RPC_HOST");
+    if (!rpc_host.empty()) {
+        schedule.rpc_host = rpc_host;
+    }
+    const std::string rpc_port = utils::getEnvVar("NODE_RPC_PORT");
+    if (!rpc_port.empty()) {
+        schedule.rpc_port = std::stoi(rpc_port);
+    }
+    const std::string poll = utils::getEnvVar("BLOCK_POLL_MS");
+    if (!poll.empty()) {
+        schedule.poll_ms = std::stoll(poll);
+    }
+    // A serial check has drained by the time it returns, a pipelined one once the graph stage took it
+    scheduler_ = std::make_unique<Scheduler>(schedule, [this]() {
+        return serial_ || graph_queue_.size_approx() == 0;
+    });
+    switch (schedule.trigger) {
+        case Trigger::NewBlock:
+            spdlog::info("Schedule: every block of {}:{}, polled every {} ms", schedule.rpc_host, schedule.rpc_port,
+                         scheduler_->config().poll_ms);
+            break;
+        case Trigger::Drain:
+            spdlog::info("Schedule: as fast as the pipeline drains, at least {} ms apart",
+                         scheduler_->config().poll_ms);
+            break;
+        default:
+            spdlog::info("Schedule: every {} ms", scheduler_->config().period_ms);
+    }
+
+    if (!serial_) {
+        runPipeline();
+    }
 
-        spdlog::info("Waiting 10s before next check.");
+    while (true) {
+        uint64_t missed = scheduler_->wait();
+        if (missed > 0) {
+            spdlog::warn("Check late, {} {} skipped", missed,
+                         schedule.trigger == Trigger::NewBlock ? "blocks" : "ticks");
+        }
 
-        sleep(10);
+        runCycle();
     }
 }
 
@@ -46,49 +214,23 @@ void Streaming::rungWebServer() {
         });
 
         server_.Get("/connections", [this](const httplib::Request &req, httplib::Response &res) {
-            // Logic
-            std::unordered_map<std::string, int> seq_mapping;
-            std::unordered_map<std::string, std::vector<Quotes>> connections;
-            std::vector<std::string> result;
-            std::unordered_map<std::string, Quotes> quotes;
+            std::vector<Quotes> quotes;
 
             // Load the data
-            if (!loadUniSwapPrices(quotes, connections)) {
-                res.set_content("No quotes", "text/plain");
-                return;
-            }
-            if (!loadSushiSwapPrices(quotes, connections)) {
+            if (!loadQuotes(quotes)) {
                 res.set_content("No quotes", "text/plain");
                 return;
             }
 
-            // Map unique symbols across all platforms
-            int position = 0;
-            for (auto const &[key, _] : connections) {
-                // remove the exchange, we want only the symbol
-                std::string addr = key;
-                size_t pos = addr.find('_');
-                addr.erase(0, pos + 1);
-                if (seq_mapping.count(addr) == 0) {
-                    seq_mapping[addr] = position;
-                    position++;
-                }
-            }
-
-            // Build the direct edges
-            std::vector<DirectedEdge *> directedEdge;
-            buildEdgeWeightedDigraph(directedEdge, quotes, connections, seq_mapping);
-            EdgeWeightedDigraph G(position);
-
-            // backwards loop to maintain the mapping of edge with asset
-            for (auto x = directedEdge.size(); x-- > 0;) {
-                G.addEdge(directedEdge[x]);
-            }
+            // A graph of its own, as this runs beside the cycle
+            MarketGraph market;
+            market.apply(quotes);
+            const EdgeWeightedDigraph &G = market.digraph();
 
             auto uuid_v4 = sole::uuid4().str();
 
             std::ofstream outfile("/tmp/connections-" + uuid_v4 + ".dot");
-            outfile << G.getGraphviz() << std::endl;
+            outfile << G.getGraphviz(market.assets()) << std::endl;
             outfile.close();
 
             std::string command =
@@ -111,342 +253,657 @@ void Streaming::rungWebServer() {
 }
 
 
-void Streaming::buildEdgeWeightedDigraph(std::vector<DirectedEdge *> &directedEdge,
-                                         std::unordered_map<std::string, Quotes> &quotes,
-                                         std::unordered_map<std::string, std::vector<Quotes>> &connections,
-                                         std::unordered_map<std::string, int> &seq_mapping) {
-    std::unordered_map<std::string, bool> connections_mapping;
-
-    for (auto const &[_, data] : quotes) {
-        for (auto const &x : connections[data.protocol + "_" + data.token0Address]) {
-            std::string key;
-            key.append(x.token0Address).append("_").append(x.token1Address).append("_").append(x.id);
-            if (connections_mapping.count(key) == 0 && connections_mapping.count(key) == 0) {
-
-                Asset asset_0;
-                asset_0.quoteId = x.id;
-                asset_0.symbol = x.token0Symbol;
-                asset_0.address = x.token0Address;
-                asset_0.protocol = x.protocol;
-                asset_0.poolID = x.poolID;
-                asset_0.decimals = x.token0decimals;
-                asset_0.derivedETH = x.token0derivedETH;
-
-                Asset asset_1;
-                asset_1.quoteId = x.id;
-                asset_1.symbol = x.token1Symbol;
-                asset_1.address = x.token1Address;
-                asset_1.protocol = x.protocol;
-                asset_1.poolID = x.poolID;
-                asset_1.decimals = x.token1decimals;
-                asset_1.derivedETH = x.token1derivedETH;
-
-                connections_mapping[key] = true;
-
-                auto *e = new DirectedEdge(seq_mapping[x.token1Address],
-                                           seq_mapping[x.token0Address],
-//                                           x.token0Price, asset_1, asset_0);
-                                           -std::log(x.token0Price), asset_1, asset_0);
-                directedEdge.emplace_back(e);
-            }
+void Streaming::runCycle() {
+    auto elapsed = make_unique<Elapsed>("Arb Cycle");
+    PipelineJob job;
+    job.id = ++snapshots_;
+
+    // Load the data
+    if (!ingest(job) || !updateGraph(job)) {
+        return;
+    }
+    detect(job);
+    sizeCandidates(job);
+
+// Send for execution
+    simulateArbitrage(job.arbitrages);
+}
+
+void Streaming::runPipeline() {
+    graph_free_.enqueue(0);
+
+    stage_threads_.emplace_back([this]() {
+        runStage(Stage::Graph, graph_queue_, &detect_queue_, [this](PipelineJob &job) { return updateGraph(job); });
+    });
+    stage_threads_.emplace_back([this]() {
+        runStage(Stage::Detect, detect_queue_, &size_queue_, [this](PipelineJob &job) { return detect(job); });
+    });
+    stage_threads_.emplace_back([this]() {
+        runStage(Stage::Size, size_queue_, &execute_queue_, [this](PipelineJob &job) { return sizeCandidates(job); });
+    });
+    stage_threads_.emplace_back([this]() {
+        runStage(Stage::Execute, execute_queue_, nullptr, [this](PipelineJob &job) {
+            simulateArbitrage(job.arbitrages);
+            return true;
+        });
+    });
+
+    // Snapshot N+1 is fetched while snapshot N is still being searched
+    while (true) {
+        uint64_t missed = scheduler_->wait();
+        if (missed > 0) {
+            spdlog::warn("Ingest late, {} {} skipped", missed,
+                         scheduler_->config().trigger == Trigger::NewBlock ? "blocks" : "ticks");
         }
 
-        for (auto const &x : connections[data.protocol + "_" + data.token1Address]) {
-            std::string key;
-            key.append(x.token1Address).append("_").append(x.token0Address).append("_").append(x.id);
-            if (connections_mapping.count(key) == 0 && connections_mapping.count(key) == 0) {
-
-                Asset asset_0;
-                asset_0.quoteId = x.id;
-                asset_0.symbol = x.token0Symbol;
-                asset_0.address = x.token0Address;
-                asset_0.protocol = x.protocol;
-                asset_0.poolID = x.poolID;
-                asset_0.decimals = x.token0decimals;
-                asset_0.derivedETH = x.token0derivedETH;
-
-                Asset asset_1;
-                asset_1.quoteId = x.id;
-                asset_1.symbol = x.token1Symbol;
-                asset_1.address = x.token1Address;
-                asset_1.protocol = x.protocol;
-                asset_1.poolID = x.poolID;
-                asset_1.decimals = x.token1decimals;
-                asset_1.derivedETH = x.token1derivedETH;
-
-                connections_mapping[key] = true;
-
-                auto *e = new DirectedEdge(seq_mapping[x.token0Address],
-                                           seq_mapping[x.token1Address],
-//                                           x.token1Price, asset_0, asset_1);
-                                           -std::log(x.token1Price), asset_0, asset_1);
-                directedEdge.emplace_back(e);
+        auto job = std::make_unique<PipelineJob>();
+        job->id = ++snapshots_;
+        job->created = PipelineJob::Clock::now();
+        bool loaded = ingest(*job);
+        auto now = PipelineJob::Clock::now();
+        job->busy_us[0] = std::chrono::duration_cast<std::chrono::microseconds>(now - job->created).count();
+        stage_stats_[0].record(job->busy_us[0], 0, 0);
+
+        if (loaded) {
+            job->queued = now;
+            job->depth[static_cast<size_t>(Stage::Graph)] = graph_queue_.size_approx();
+            graph_queue_.enqueue(std::move(job));
+        }
+    }
+}
+
+void Streaming::runStage(Stage stage, JobQueue &in, JobQueue *out,
+                         const std::function<bool(PipelineJob &)> &work) {
+    const auto s = static_cast<size_t>(stage);
+    while (true) {
+        std::unique_ptr<PipelineJob> job;
+        in.wait_dequeue(job);
+
+        // The graph is still in use by the previous snapshot until it has been sized
+        if (stage == Stage::Graph) {
+            int token;
+            graph_free_.wait_dequeue(token);
+
+            // Snapshots are complete, the newest one queued meanwhile replaces the older ones
+            std::unique_ptr<PipelineJob> newer;
+            while (in.try_dequeue(newer)) {
+                spdlog::warn("Snapshot {} dropped, superseded by snapshot {}", job->id, newer->id);
+                // a check on the Sync events alone still needs the quotes of the subgraphs it replaced
+                if (job->snapshot && !newer->snapshot) {
+                    newer->quotes = std::move(job->quotes);
+                    newer->snapshot = true;
+                }
+                newer->unsync = newer->unsync || job->unsync;
+                job = std::move(newer);
             }
         }
+
+        auto start = PipelineJob::Clock::now();
+        job->wait_us[s] = std::chrono::duration_cast<std::chrono::microseconds>(start - job->queued).count();
+        bool pass = false;
+        try {
+            pass = work(*job);
+        } catch (std::exception &e) {
+            spdlog::error("Pipeline {} stage error on snapshot {}: {}", stageName(stage), job->id, e.what());
+        }
+        auto now = PipelineJob::Clock::now();
+        job->busy_us[s] = std::chrono::duration_cast<std::chrono::microseconds>(now - start).count();
+        stage_stats_[s].record(job->busy_us[s], job->wait_us[s], job->depth[s]);
+
+        // Whatever happened to the snapshot, past sizing the graph is free for the next one
+        bool holds_graph = stage == Stage::Graph || stage == Stage::Detect;
+        if (stage == Stage::Size || (holds_graph && !pass)) {
+            graph_free_.enqueue(0);
+        }
+
+        if (!pass) {
+            continue;
+        }
+        if (out == nullptr) {
+            reportPipeline(*job);
+            continue;
+        }
+        job->queued = now;
+        job->depth[s + 1] = out->size_approx();
+        out->enqueue(std::move(job));
     }
 }
 
-void Streaming::runCycle() {
-    auto elapsed = make_unique<Elapsed>("Arb Cycle");
-    // Logic
-    std::unordered_map<std::string, int> seq_mapping;
-    std::unordered_map<std::string, std::vector<Quotes>> connections;
-    std::vector<std::string> result;
-    std::unordered_map<std::string, Quotes> quotes;
-    std::vector<Arbitrage> arbitrages;
+void Streaming::reportPipeline(const PipelineJob &job) {
+    auto total = std::chrono::duration_cast<std::chrono::microseconds>(
+            PipelineJob::Clock::now() - job.created).count();
+    std::string stages;
+    for (size_t s = 0; s < kStages; s++) {
+        stages += fmt::format(" | {} {:.1f} ms", stageName(static_cast<Stage>(s)), job.busy_us[s] / 1000.0);
+        if (s > 0) {
+            stages += fmt::format(" (queued {:.1f} ms behind {})", job.wait_us[s] / 1000.0, job.depth[s]);
+        }
+    }
+    spdlog::info("Snapshot {} through the pipeline in {:.1f} ms{}", job.id, total / 1000.0, stages);
+
+    // Running averages every 10 snapshots
+    if (job.id % 10 != 0) return;
+    for (size_t s = 0; s < kStages; s++) {
+        const StageStats &stats = stage_stats_[s];
+        uint64_t jobs = std::max<uint64_t>(1, stats.jobs);
+        spdlog::info("Stage {}: {} snapshots, {:.1f} ms average, {:.1f} ms max, {:.1f} ms queued average, depth max {}",
+                     stageName(static_cast<Stage>(s)), stats.jobs.load(), stats.busy_us / 1000.0 / jobs,
+                     stats.max_busy_us / 1000.0, stats.wait_us / 1000.0 / jobs, stats.max_depth.load());
+    }
+}
 
-    // Load the data
-    if (!loadUniSwapPrices(quotes, connections)) {
-        spdlog::error("Problem loading uniswap prices");
-        return;
+bool Streaming::ingest(PipelineJob &job) {
+    // Between the snapshots, the Sync events alone move the graph,
+    // unless they were interrupted, then the next snapshot takes the pools back
+    auto now = PipelineJob::Clock::now();
+    job.unsync = sync_reset_.exchange(false);
+    if (sync_subscriber_ && now < next_snapshot_ && !job.unsync) {
+        return true;
     }
-    if (!loadSushiSwapPrices(quotes, connections)) {
-        spdlog::error("Problem loading sushiswap prices");
-        return;
+    if (!loadQuotes(job.quotes)) {
+        // the snapshot owed is retried by the next ingest
+        if (job.unsync) sync_reset_ = true;
+        return false;
     }
+    job.snapshot = true;
+    next_snapshot_ = now + std::chrono::milliseconds(sync_snapshot_ms_);
+    return true;
+}
 
-    // Map unique addrs across all platforms
-    int position = 0;
-    for (auto const &[key, _] : connections) {
-        // remove the exchange, we want only the addr
-        std::string addr = key;
-        size_t pos = addr.find('_');
-        addr.erase(0, pos + 1);
-        if (seq_mapping.count(addr) == 0) {
-            seq_mapping[addr] = position;
-            position++;
-        }
+bool Streaming::updateGraph(PipelineJob &job) {
+    // Patch the graph of the previous cycle with the new snapshot
+    GraphDelta &delta = job.delta;
+    if (job.unsync) {
+        spdlog::warn("Sync logs interrupted, reserves back to the subgraph snapshots");
+        market_.unsync();
+    }
+    if (job.snapshot) {
+        delta = market_.apply(job.quotes);
     }
+    applySyncEvents(delta);
+    if (!job.snapshot && delta.empty()) {
+        return false;
+    }
+    spdlog::info("Graph: {} vertices, {} edges | {} repriced, {} new edges, {} new vertices, {} pools deactivated, "
+                 "{} pools synced", market_.V(), market_.E(), delta.updated.size(), delta.added.size(),
+                 delta.new_vertices, delta.deactivated, delta.synced);
+    job.quotes.clear();
 
-    // Build the direct edges
-    std::vector<DirectedEdge *> directedEdge;
-    buildEdgeWeightedDigraph(directedEdge, quotes, connections, seq_mapping);
-    EdgeWeightedDigraph G(position);
+    // Contiguous arrays for the relaxation loops, refrozen only on structural change
+    const CsrDigraph &csr = market_.csr();
 
-    // Backwards loop to maintain the mapping of edge with asset with the right position
-    for (auto x = directedEdge.size(); x-- > 0;) {
-        G.addEdge(directedEdge[x]);
+    if (!graph_record_dir_.empty()) {
+        recordGraph(csr);
     }
+    return true;
+}
+
+void Streaming::applySyncEvents(GraphDelta &delta) {
+    SyncEvent event;
+    while (sync_events_.try_dequeue(event)) {
+        uint32_t pool;
+        if (!market_.findPool(event.pair, pool)) {
+            continue;
+        }
+        // The reserves before a reverted log are unknown, and the new chain may never touch
+        // the pool again: the next snapshot restores it, unless a newer Sync event comes first
+        if (event.removed) {
+            market_.unsync(pool);
+            continue;
+        }
+        market_.sync(pool, event.reserve0, event.reserve1, event.block, delta);
+    }
+}
+
+bool Streaming::detect(PipelineJob &job) {
+    const CsrDigraph &csr = market_.csr();
+    const GraphDelta &delta = job.delta;
 
     spdlog::info("Checking arbitrage opportunities");
-    std::unordered_map<std::string, bool> hash;
-    for (int i = 0; i < position; i++) {
-        // find negative cycle
-        BellmanFordSP spt(G, i);
-
-        if (spt.hasNegativeCycle()) {
-            stack<DirectedEdge *> edges(spt.negativeCycle());
-            std::string output;
-            double stake = 1;
-            double final_stake = stake;
-
-            Arbitrage arbitrage;
-            while (!edges.empty()) {
-                char *m1 = nullptr;
-                asprintf(&m1, "%10.5f %s-%s-%s ", final_stake, edges.top()->asset_from().protocol.c_str(),
-                         edges.top()->asset_from().symbol.c_str(), edges.top()->asset_from().address.c_str());
-                output.append(m1);
-                free(m1);
-
-                final_stake *= std::exp(-edges.top()->weight());
-
-                char *m2 = nullptr;
-                asprintf(&m2, "= %10.5f %s-%s-%s\n", final_stake, edges.top()->asset_to().protocol.c_str(),
-                         edges.top()->asset_to().symbol.c_str(), edges.top()->asset_to().address.c_str());
-                output.append(m2);
-                free(m2);
-
-                if (arbitrage.currency_return.empty()) {
-                    arbitrage.currency_return = edges.top()->asset_from().symbol;
-                    arbitrage.decimal_base = edges.top()->asset_from().decimals;
-                    arbitrage.derivedETH = edges.top()->asset_from().derivedETH;
-                }
+    std::vector<stack<DirectedEdge *>> &cycles = job.cycles;
+    if (detection_mode_ == DetectionMode::Incremental) {
+        // restart only from the edges the snapshot repriced, unless the structure changed
+        if (!detector_) {
+            detector_ = std::make_unique<IncrementalBellmanFord>(csr);
+        } else if (delta.structural()) {
+            detector_->reset(csr);
+        } else {
+            std::vector<int> slots;
+            slots.reserve(delta.updated.size());
+            for (uint32_t id : delta.updated) slots.emplace_back(market_.slot(id));
+            detector_->update(slots);
+        }
+        spdlog::info("{} search: {} relaxations", detector_->incremental() ? "Incremental" : "Full",
+                     detector_->relaxations());
+        cycles = detector_->negativeCycles();
+    } else {
+        // cycles never leave a strong component, search the components on the detection pool
+        findComponentCycles(csr, cycles);
+    }
+
+    if (top_k_ > 0) {
+        // the detectors report the first cycles they run into, keep only the most profitable
+        TopKCycles top(top_k_);
+        for (auto const &cycle : cycles) top.offer(cycle);
+        int searched = top.search(csr, top_k_);
+        std::vector<TopKCycles::Candidate> best = top.ranked();
+        spdlog::info("{} distinct negative cycles, {} from minimum mean cycles, keeping the best {}{}",
+                     top.candidates(), searched, best.size(),
+                     best.empty() ? "" : fmt::format(" (best return {:.5f})", best.front().profit()));
+        cycles.clear();
+        for (auto &candidate : best) cycles.emplace_back(std::move(candidate.cycle));
+    }
+    return true;
+}
 
-                arbitrage.addr.emplace_back(edges.top()->asset_from().address);
-                arbitrage.addr.emplace_back(edges.top()->asset_to().address);
-                arbitrage.exchange.emplace_back(edges.top()->asset_to().protocol);
-                arbitrage.pool.emplace_back(edges.top()->asset_to().poolID);
+bool Streaming::sizeCandidates(PipelineJob &job) {
+    const AssetTable &assets = market_.assets();
+    const std::vector<stack<DirectedEdge *>> &cycles = job.cycles;
+    std::vector<Arbitrage> &arbitrages = job.arbitrages;
 
-                edges.pop();
-            }
+    // The same route comes out of several searches, and from any of its vertices:
+    // keep one of each before formatting anything
+    std::unordered_set<uint64_t> seen;
+
+    // Size every candidate against the pool reserves in one pass
+    SwapSimulator simulator(assets);
+    std::vector<SwapSimulation> simulations;
+    simulator.optimize(cycles, simulations);
 
-            // We can have multiple executions with the same path, so, lets make sure we get only one
-            const std::string executionhash = md5_from_file(output);
-            if (hash.count(executionhash)) {
-                // if the hash already exist, we dont need to add it again
-                continue;
+    for (size_t c = 0; c < cycles.size(); c++) {
+        const stack<DirectedEdge *> &cycle = cycles[c];
+        if (!seen.insert(cycleKey(cycle)).second) {
+            continue;
+        }
+
+        stack<DirectedEdge *> edges(cycle);
+        std::string output;
+        double stake = 1;
+        double final_stake = stake;
+
+        Arbitrage arbitrage;
+        while (!edges.empty()) {
+            const DirectedEdge &edge = *edges.top();
+            const Asset &from = assets.from(edge);
+            const Asset &to = assets.to(edge);
+            const Pool &pool = assets.pool(edge);
+
+            char *m1 = nullptr;
+            asprintf(&m1, "%10.5f %s-%s-%s ", final_stake, pool.protocol.c_str(),
+                     from.symbol.c_str(), from.address.c_str());
+            output.append(m1);
+            free(m1);
+
+            final_stake *= std::exp(-edge.weight());
+
+            char *m2 = nullptr;
+            asprintf(&m2, "= %10.5f %s-%s-%s\n", final_stake, pool.protocol.c_str(),
+                     to.symbol.c_str(), to.address.c_str());
+            output.append(m2);
+            free(m2);
+
+            if (arbitrage.currency_return.empty()) {
+                arbitrage.currency_return = from.symbol;
+                arbitrage.decimal_base = from.decimals;
+                arbitrage.derivedETH = from.derivedETH;
             }
 
-            hash[executionhash] = true;
-            arbitrage.output = output;
+            arbitrage.addr.emplace_back(from.address);
+            arbitrage.addr.emplace_back(to.address);
+            arbitrage.exchange.emplace_back(pool.protocol);
+            arbitrage.pool.emplace_back(pool.poolID);
+
+            edges.pop();
+        }
+
+        arbitrage.output = output;
+
+        arbitrage.amount_in = simulations[c].amount_in;
+        arbitrage.profit = simulations[c].profit();
+        if (arbitrage.profit > 0.0) {
+            // screened in double, now what the pools would actually pay, wei rounding included
+            arbitrage.profit = simulator.verify(cycle, arbitrage.amount_in).profit();
+        }
 
-            // Only if starts with WETH - kovan and mainnet
+        // Only if starts with WETH - kovan and mainnet
 //            if (arbitrage.addr[0] == "0xd0a1e359811322d97991e03f863a0c30c2cf029c" ||
 //                arbitrage.addr[0] == "0xC02aaA39b223FE8D0A0e5C4F27eAD9083C756Cc2") {
 //                arbitrages.emplace_back(arbitrage);
 //            }
-            arbitrages.emplace_back(arbitrage);
+        arbitrages.emplace_back(arbitrage);
 
-            //cout << output << endl;
-        } else {
-            // cout << "No negative cycle" << endl;
-        }
+        //cout << output << endl;
     }
 
-// Send for execution
-    simulateArbitrage(arbitrages);
+    // The edges belong to the graph, the next snapshot may reprice them
+    job.cycles.clear();
+    return true;
 }
 
-void Streaming::simulateArbitrage(const std::vector<Arbitrage> &arbitrages) {
-    try {
-        if (arbitrages.empty()) {
-            spdlog::info("No Opportunities found");
-            return;
-        }
+void Streaming::recordGraph(const CsrDigraph &csr) {
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string path = graph_record_dir_ + "/graph-" + std::to_string(now) + ".txt";
 
-        spdlog::info("{} Opportunities found, sending it over to further check", arbitrages.size());
+    // The format read by EdgeWeightedDigraph: V, E, then one "v w weight" line per edge
+    FILE *out = fopen(path.c_str(), "w");
+    if (out == nullptr) {
+        spdlog::error("Could not record the graph to {}", path);
+        return;
+    }
+    fprintf(out, "%d\n%d\n", csr.V(), csr.E());
+    for (int v = 0; v < csr.V(); v++) {
+        for (int i = csr.offsets()[v]; i < csr.offsets()[v + 1]; i++) {
+            fprintf(out, "%d %d %.17g\n", v, csr.to()[i], csr.weight()[i]);
+        }
+    }
+    fclose(out);
+}
 
-        double final_profit = 0.0;
-        double final_profit_ETH = 0.0;
-        int current_index = 0;
-        int execution_index = 0;
-        double optimal_volume = 0;
-        std::string execution_json;
+void Streaming::findComponentCycles(const CsrDigraph &csr, std::vector<stack<DirectedEdge *>> &cycles) {
+    TarjanSCC scc(csr);
+
+    // Copy every component that can hold an arbitrage into a graph of its own.
+    // Vertices are renumbered, the copied edges keep their pool so that the
+    // cycles found read the same as on the full graph
+    component_arena_.reset();
+    std::vector<std::unique_ptr<CsrDigraph>> components;
+    std::vector<int> local(csr.V());
+    int kept_vertices = 0;
+    int kept_edges = 0;
+    for (const std::vector<int> &component : scc.components()) {
+        if (component.size() < 2) continue;
+        for (size_t k = 0; k < component.size(); k++) local[component[k]] = k;
+
+        EdgeWeightedDigraph G(component.size());
+        for (int v : component) {
+            for (int i = csr.offsets()[v]; i < csr.offsets()[v + 1]; i++) {
+                int w = csr.to()[i];
+                if (scc.id(w) != scc.id(v) || std::isinf(csr.weight()[i])) continue;  // deactivated pool
+                const DirectedEdge *e = csr.edge(i);
+                G.addEdge(component_arena_.create(local[v], local[w], csr.weight()[i], e->pool(), e->zero_for_one()));
+            }
+        }
+        // a single pool and its round trip, which always pays the fee twice
+        if (G.E() < 3) continue;
 
-        for (auto const &arb : arbitrages) {
-            rapidjson::Document request_document;
-            rapidjson::Document::AllocatorType &allocator = request_document.GetAllocator();
-            request_document.SetObject();
+        kept_vertices += G.V();
+        kept_edges += G.E();
+        components.emplace_back(std::make_unique<CsrDigraph>(G));
+    }
 
-            rapidjson::Value obj(rapidjson::kObjectType);
-            rapidjson::Value val(rapidjson::kObjectType);
-            rapidjson::Value exchangeArray(rapidjson::kArrayType);
-            rapidjson::Value addrArray(rapidjson::kArrayType);
-            rapidjson::Value poolArray(rapidjson::kArrayType);
+    spdlog::info("SCC pruning: {} of {} vertices and {} of {} edges kept in {} components, {:.1f}% of the vertices pruned",
+                 kept_vertices, csr.V(), kept_edges, csr.E(), components.size(),
+                 csr.V() ? 100.0 * (csr.V() - kept_vertices) / csr.V() : 0.0);
+
+    // Largest components first. A super-source search is a single task, per-source
+    // searches are split in runs of sources so that every worker gets a share
+    std::sort(components.begin(), components.end(), [](auto const &a, auto const &b) {
+        return a->E() > b->E();
+    });
+    using Cycles = std::vector<stack<DirectedEdge *>>;
+    std::vector<std::future<Cycles>> searches;
+    for (auto const &component : components) {
+        const CsrDigraph &G = *component;
+        if (detection_mode_ == DetectionMode::SuperSource) {
+            searches.emplace_back(detection_pool_->enqueue([&G]() {
+                // find every negative cycle of the component in a single pass
+                BellmanFordSP spt(G);
+                return spt.negativeCycles();
+            }));
+            continue;
+        }
+        if (detection_mode_ == DetectionMode::Tarjan) {
+            searches.emplace_back(detection_pool_->enqueue([&G]() {
+                // every negative cycle of the component, closed as soon as the tree does
+                TarjanCycleDetector detector(G);
+                return detector.negativeCycles();
+            }));
+            continue;
+        }
 
-            for (auto const &x : arb.exchange) {
-                val.SetString(x.c_str(), static_cast<rapidjson::SizeType>(x.length()),
-                              allocator);
-                exchangeArray.PushBack(val, allocator);
+        int run = std::max(1, G.V() / (detection_workers_ * 4));
+        if (detection_mode_ == DetectionMode::HopBounded) {
+            // every short route, each reported from its smallest vertex: runs of
+            // vertices split the enumeration without overlap
+            for (int first = 0; first < G.V(); first += run) {
+                int last = std::min(G.V(), first + run);
+                searches.emplace_back(detection_pool_->enqueue([&G, first, last, hops = max_hops_]() {
+                    switch (hops) {
+                        case 2:
+                            return HopBoundedCycles<2>(G, first, last).cycles();
+                        case 3:
+                            return HopBoundedCycles<3>(G, first, last).cycles();
+                        default:
+                            return HopBoundedCycles<4>(G, first, last).cycles();
+                    }
+                }));
             }
+            continue;
+        }
 
-            for (auto const &x : arb.addr) {
-                val.SetString(x.c_str(), static_cast<rapidjson::SizeType>(x.length()),
-                              allocator);
-                addrArray.PushBack(val, allocator);
-            }
+        for (int first = 0; first < G.V(); first += run) {
+            int last = std::min(G.V(), first + run);
+            searches.emplace_back(detection_pool_->enqueue([&G, first, last]() {
+                // one workspace for the whole run of sources
+                BellmanFordSolver solver(G);
+                Cycles found;
+                for (int i = first; i < last; i++) {
+                    // find negative cycle
+                    if (solver.run(i)) {
+                        found.emplace_back(solver.negativeCycle());
+                    }
+                }
+                return found;
+            }));
+        }
+    }
 
-            for (auto const &x : arb.pool) {
-                val.SetString(x.c_str(), static_cast<rapidjson::SizeType>(x.length()),
-                              allocator);
-                poolArray.PushBack(val, allocator);
-            }
+    // Merge in submission order, duplicates are dropped with the rest by the caller
+    for (auto &search : searches) {
+        Cycles found = search.get();
+        std::move(found.begin(), found.end(), std::back_inserter(cycles));
+    }
+}
 
-            val.SetString(arb.output.c_str(),
-                          static_cast<rapidjson::SizeType>(arb.output.length()),
-                          allocator);
-            request_document.AddMember("output", val, allocator);
-            request_document.AddMember("exchange", exchangeArray, allocator);
-            request_document.AddMember("addr", addrArray, allocator);
-            request_document.AddMember("pool", poolArray, allocator);
+std::string Streaming::simulationRequest(const Arbitrage &arb, double starting_volume, int id) const {
+    rapidjson::Document request_document;
+    rapidjson::Document::AllocatorType &allocator = request_document.GetAllocator();
+    request_document.SetObject();
 
-            val.SetDouble(initial_volume_);
-            request_document.AddMember("starting_volume", val, allocator);
+    rapidjson::Value val(rapidjson::kObjectType);
+    rapidjson::Value exchangeArray(rapidjson::kArrayType);
+    rapidjson::Value addrArray(rapidjson::kArrayType);
+    rapidjson::Value poolArray(rapidjson::kArrayType);
 
-            val.SetInt64(arb.decimal_base);
-            request_document.AddMember("decimal_base", val, allocator);
+    for (auto const &x : arb.exchange) {
+        val.SetString(x.c_str(), static_cast<rapidjson::SizeType>(x.length()),
+                      allocator);
+        exchangeArray.PushBack(val, allocator);
+    }
 
-            val.SetString(arb.currency_return.c_str(),
-                          static_cast<rapidjson::SizeType>(arb.currency_return.length()),
-                          allocator);
-            request_document.AddMember("currency_return", val, allocator);
+    for (auto const &x : arb.addr) {
+        val.SetString(x.c_str(), static_cast<rapidjson::SizeType>(x.length()),
+                      allocator);
+        addrArray.PushBack(val, allocator);
+    }
 
-            val.SetDouble(arb.derivedETH);
-            request_document.AddMember("derivedETH", val, allocator);
+    for (auto const &x : arb.pool) {
+        val.SetString(x.c_str(), static_cast<rapidjson::SizeType>(x.length()),
+                      allocator);
+        poolArray.PushBack(val, allocator);
+    }
 
-            rapidjson::StringBuffer sb;
-            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(sb);
-            request_document.Accept(writer);
+    val.SetString(arb.output.c_str(),
+                  static_cast<rapidjson::SizeType>(arb.output.length()),
+                  allocator);
+    request_document.AddMember("output", val, allocator);
+    request_document.AddMember("exchange", exchangeArray, allocator);
+    request_document.AddMember("addr", addrArray, allocator);
+    request_document.AddMember("pool", poolArray, allocator);
 
-            std::string url = "/simulation";
-            auto res = nodeRequest_->Post(url.c_str(), sb.GetString(), "application/json");
-            if (res == nullptr) {
-                spdlog::error("Node api error 1: {}", "nullptr");
-                return;
-            }
+    val.SetDouble(starting_volume);
+    request_document.AddMember("starting_volume", val, allocator);
 
-            if (res.error()) {
-                spdlog::error("Node api error 2: {}", res.error());
-                return;
-            }
+    val.SetInt64(arb.decimal_base);
+    request_document.AddMember("decimal_base", val, allocator);
 
-            rapidjson::Document document;
+    val.SetString(arb.currency_return.c_str(),
+                  static_cast<rapidjson::SizeType>(arb.currency_return.length()),
+                  allocator);
+    request_document.AddMember("currency_return", val, allocator);
 
-            // Parse the JSON
-            if (document.Parse(res->body.c_str()).HasParseError()) {
-                spdlog::error("Node api document parse error: {}", res->body.c_str());
-                return;
-            }
+    val.SetDouble(arb.derivedETH);
+    request_document.AddMember("derivedETH", val, allocator);
 
-            if (!document.IsObject()) {
-                spdlog::error("Node api  error: {}", "No data");
-                return;
-            }
+    if (id >= 0) {
+        val.SetInt(id);
+        request_document.AddMember("id", val, allocator);
+    }
 
-            if (document.HasMember("error")) {
-                const rapidjson::Value &error = document["error"];
-                if (error.GetBool()) {
-                    const rapidjson::Value &message = document["message"];
-                    spdlog::error("Node api: {}", message.GetString());
-                }
-            } else {
-                spdlog::error("Node api return does not contain a error status");
-                return;
-            }
-            if (document.HasMember("profit")) {
-                const rapidjson::Value &profit = document["profit"];
-                const rapidjson::Value &optimalVol = document["optimal_volume"];
-
-                if (final_profit_ETH < profit.GetDouble()) {
-                    final_profit = profit.GetDouble();
-                    final_profit_ETH = profit.GetDouble() / arbitrages[current_index].derivedETH;
-                    optimal_volume = optimalVol.GetDouble();
-                    execution_json = sb.GetString();
-                    execution_index = current_index;
-                }
-            }
-            current_index++;
+    // Compact, the node parses it anyway
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    request_document.Accept(writer);
+    return sb.GetString();
+}
+
+bool Streaming::nodeSimulation(httplib::Client &client, const std::string &request, int id,
+                               NodeSimulation &simulation) {
+    std::string url = "/simulation";
+    auto res = client.Post(url.c_str(), request, "application/json");
+    if (res == nullptr) {
+        spdlog::error("Node api error 1: {}", "nullptr");
+        return false;
+    }
+
+    if (res.error()) {
+        spdlog::error("Node api error 2: {}", res.error());
+        return false;
+    }
+
+    rapidjson::Document document;
+
+    // Parse the JSON
+    if (document.Parse(res->body.c_str()).HasParseError()) {
+        spdlog::error("Node api document parse error: {}", res->body.c_str());
+        return false;
+    }
+
+    if (!document.IsObject()) {
+        spdlog::error("Node api  error: {}", "No data");
+        return false;
+    }
+
+    // Replies that echo the id must answer the request sent on this connection
+    if (document.HasMember("id") && document["id"].IsInt() && document["id"].GetInt() != id) {
+        spdlog::error("Node api reply for {} received for {}", document["id"].GetInt(), id);
+        return false;
+    }
+
+    if (document.HasMember("error")) {
+        const rapidjson::Value &error = document["error"];
+        if (error.GetBool()) {
+            const rapidjson::Value &message = document["message"];
+            spdlog::error("Node api: {}", message.GetString());
         }
+    } else {
+        spdlog::error("Node api return does not contain a error status");
+        return false;
+    }
 
-        spdlog::info("Simulation check finished");
+    if (!document.HasMember("profit")) {
+        return false;
+    }
+    simulation.profit = document["profit"].GetDouble();
+    simulation.optimal_volume = document["optimal_volume"].GetDouble();
+    simulation.confirmed = true;
+    return true;
+}
 
-        if (final_profit > 0) {
-            spdlog::info("Profitable operation found {}", final_profit);
-            if (final_profit > 0) {
-                rapidjson::Document trade_doc;
-                if (trade_doc.Parse(execution_json.c_str()).HasParseError()) {
-                    spdlog::error("Trade doc parse error: {}", execution_json);
-                    return;
-                }
-                if (!trade_doc.IsObject()) {
-                    spdlog::error("Trade doc error: {}", "No data");
-                    return;
-                }
+void Streaming::simulateArbitrage(const std::vector<Arbitrage> &arbitrages) {
+    try {
+        if (arbitrages.empty()) {
+            spdlog::info("No Opportunities found");
+            return;
+        }
 
-                trade_doc["starting_volume"] = optimal_volume;
+        // Every candidate was replayed against the pool reserves, rank the profitable ones in ETH
+        std::vector<int> ranked;
+        for (size_t i = 0; i < arbitrages.size(); i++) {
+            if (arbitrages[i].profit > 0.0) ranked.emplace_back(static_cast<int>(i));
+        }
+        std::sort(ranked.begin(), ranked.end(), [&arbitrages](int a, int b) {
+            return arbitrages[a].profit * arbitrages[a].derivedETH > arbitrages[b].profit * arbitrages[b].derivedETH;
+        });
 
-                rapidjson::StringBuffer sb;
-                rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(sb);
-                trade_doc.Accept(writer);
+        spdlog::info("{} Opportunities simulated, {} profitable", arbitrages.size(), ranked.size());
 
-                spdlog::info("Operation payload {}", sb.GetString());
-                spdlog::info("Sending execution and expecting {} {} equivalent to {} ETH.", final_profit,
-                             arbitrages[execution_index].currency_return, final_profit_ETH);
+        if (ranked.empty()) {
+            spdlog::info("No Profitable profits profits after fees");
+            return;
+        }
+
+        int execution_index = ranked.front();
+        double final_profit = arbitrages[execution_index].profit;
+        double optimal_volume = arbitrages[execution_index].amount_in;
+        double final_profit_ETH = final_profit * arbitrages[execution_index].derivedETH;
+        spdlog::info("Best simulated operation: {} {} in, {} {} profit", optimal_volume,
+                     arbitrages[execution_index].currency_return, final_profit,
+                     arbitrages[execution_index].currency_return);
+
+        if (confirm_simulation_) {
+            // The node replays the best candidates on the chain state. Each persistent
+            // connection carries a lane of requests, so that they all come back in
+            // about one round trip instead of one per candidate
+            if (ranked.size() > static_cast<size_t>(confirm_top_)) ranked.resize(confirm_top_);
+            std::vector<NodeSimulation> replies(ranked.size());
+            size_t lanes = std::min(ranked.size(), simulation_clients_.size());
+            std::vector<std::future<void>> in_flight;
+            auto elapsed = make_unique<Elapsed>("Node simulation");
+            for (size_t lane = 0; lane < lanes; lane++) {
+                in_flight.emplace_back(simulation_pool_->enqueue([this, lane, lanes, &ranked, &arbitrages, &replies]() {
+                    for (size_t k = lane; k < ranked.size(); k += lanes) {
+                        const Arbitrage &arb = arbitrages[ranked[k]];
+                        nodeSimulation(*simulation_clients_[lane], simulationRequest(arb, arb.amount_in, ranked[k]),
+                                       ranked[k], replies[k]);
+                    }
+                }));
+            }
+            for (auto &lane : in_flight) lane.get();
+            elapsed.reset();
+
+            execution_index = -1;
+            final_profit_ETH = 0.0;
+            int confirmed = 0;
+            for (size_t k = 0; k < ranked.size(); k++) {
+                if (!replies[k].confirmed) continue;
+                confirmed++;
+                double profit_ETH = replies[k].profit * arbitrages[ranked[k]].derivedETH;
+                if (profit_ETH > final_profit_ETH) {
+                    execution_index = ranked[k];
+                    final_profit = replies[k].profit;
+                    optimal_volume = replies[k].optimal_volume;
+                    final_profit_ETH = profit_ETH;
+                }
+            }
+            spdlog::info("Simulation check finished, {} of {} confirmed", confirmed, ranked.size());
 
-                executeArbitrage(arbitrages[execution_index], sb.GetString());
-            } else {
-                spdlog::info("No Profitable profits profits after fees");
+            if (execution_index < 0) {
+                spdlog::info("Nothing to execute");
+                return;
             }
+        }
+
+        if (final_profit > 0) {
+            const Arbitrage &best = arbitrages[execution_index];
+            std::string execution_json = simulationRequest(best, optimal_volume);
+            spdlog::info("Profitable operation found {}", final_profit);
+            spdlog::info("Operation payload {}", execution_json);
+            spdlog::info("Sending execution and expecting {} {} equivalent to {} ETH.", final_profit,
+                         best.currency_return, final_profit_ETH);
+
+            executeArbitrage(best, execution_json);
         } else {
             spdlog::info("Nothing to execute");
         }
@@ -532,184 +989,28 @@ void Streaming::executeArbitrage(const Arbitrage &arbitrage, const std::string &
     }
 }
 
-bool Streaming::loadUniSwapPrices(std::unordered_map<std::string, Quotes> &quotes,
-                                  std::unordered_map<std::string, std::vector<Quotes>> &connections) {
-    try {
-        rapidjson::Document document;
-
-        std::string url = "/subgraphs/name/uniswap/uniswap-v2";
-        //std::string url = "/subgraphs/name/maurodelazeri/uniswapv2-kovan";
-        std::string data = R"({ "query": "{ pairs(first: 1000, where: {reserveUSD_gt: 10000, volumeUSD_gt: 5000}, orderBy: reserveUSD, orderDirection: desc) { token0 { id symbol name decimals derivedETH } token1 { id symbol name decimals derivedETH } id reserve0 reserve1 token0Price token1Price reserveETH reserveUSD volumeUSD } }"})";
-
-        auto res = graphRequest_->Post(url.c_str(), data, "application/json");
-        if (res == nullptr) {
-            spdlog::error("Uniswap subgraph error: {}", "nullptr");
-            return false;
-        }
-
-        if (res.error()) {
-            spdlog::error("Uniswap subgraph error: {}", res.error());
-            return false;
-        }
-
-        // Parse the JSON
-        if (document.Parse(res->body.c_str()).HasParseError()) {
-            spdlog::error("Uniswap subgraph document parse error: {}", res->body.c_str());
-            return false;
-        }
-
-        if (!document.IsObject()) {
-            spdlog::error("Uniswap subgraph error: {}", "No data");
-            return false;
-        }
-
-        // Put the data int the struct
-        if (document.HasMember("data")) {
-            if (document["data"].HasMember("pairs")) {
-                if (document["data"]["pairs"].IsArray()) {
-                    const rapidjson::Value &pairs = document["data"]["pairs"];
-                    for (rapidjson::SizeType i = 0; i < pairs.Size(); i++) {
-                        Quotes quote;
-                        quote.id = sole::uuid4().str();
-                        quote.protocol = "UNISWAP";
-                        quote.poolID = pairs[i]["id"].GetString();
-
-                        // Token 0
-                        quote.token0Symbol = pairs[i]["token0"]["symbol"].GetString();
-                        quote.token0decimals = std::stoi(
-                                pairs[i]["token0"]["decimals"].GetString());
-                        quote.token0Address = pairs[i]["token0"]["id"].GetString();
-                        quote.token0Price =
-                                std::stod(pairs[i]["token0Price"].GetString());
-                        quote.token0derivedETH = std::stod(pairs[i]["token0"]["derivedETH"].GetString());
-
-                        // Token 1
-                        quote.token1Symbol = pairs[i]["token1"]["symbol"].GetString();
-                        quote.token1decimals = std::stoi(
-                                pairs[i]["token1"]["decimals"].GetString());
-                        quote.token1Address = pairs[i]["token1"]["id"].GetString();
-                        quote.token1Price =
-                                std::stod(pairs[i]["token1Price"].GetString());
-                        quote.token1derivedETH = std::stod(pairs[i]["token1"]["derivedETH"].GetString());
-
-                        if (quote.token0Symbol.empty() || quote.token1Symbol.empty()) {
-                            rapidjson::StringBuffer sb;
-                            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(sb);
-                            pairs[i].Accept(writer);
-                            puts(sb.GetString());
-                            spdlog::warn("Uniswap problem with pair: {}", sb.GetString());
-                            continue;
-                        }
-
-                        // Unique ID
-                        quotes[quote.id] = quote;
-                        connections[quote.protocol + "_" + quote.token1Address].emplace_back(quote);
-                        connections[quote.protocol + "_" + quote.token0Address].emplace_back(quote);
-                    }
-                    if (quotes.empty()) {
-                        spdlog::warn("No quotes for Uniswap");
-                        return false;
-                    }
-                } else {
-                    return false;
-                }
-            } else {
-                return false;
-            }
-        } else {
-            return false;
-        }
-        return true;
-    } catch (std::exception &e) {
-        spdlog::error("Uniswap subgraph parse error: {}", e.what());
+bool Streaming::loadQuotes(std::vector<Quotes> &quotes) {
+    // Every source fetches and parses into its own buffer at the same time
+    std::vector<std::vector<Quotes>> buffers(sources_.size());
+    std::vector<std::future<bool>> loads;
+    for (size_t i = 0; i < sources_.size(); i++) {
+        loads.emplace_back(std::async(std::launch::async, [this, &buffers, i]() {
+            return sources_[i]->load(buffers[i]);
+        }));
     }
-    return false;
-}
 
-bool Streaming::loadSushiSwapPrices(std::unordered_map<std::string, Quotes> &quotes,
-                                    std::unordered_map<std::string, std::vector<Quotes>> &connections) {
-    try {
-        rapidjson::Document document;
-        std::string url = "/subgraphs/name/croco-finance/sushiswap";
-        std::string data = R"({ "query": "{ pairs(first: 1000, where: {reserveUSD_gt: 10000, volumeUSD_gt: 5000}, orderBy: reserveUSD, orderDirection: desc) { token0 { id symbol name decimals derivedETH } token1 { id symbol name decimals derivedETH } id reserve0 reserve1 token0Price token1Price reserveETH reserveUSD volumeUSD } }"})";
-
-        auto res = graphRequest_->Post(url.c_str(), data, "application/json");
-        if (res == nullptr) {
-            spdlog::error("Sushiswap subgraph error: {}", "nullptr");
-            return false;
-        }
-
-        if (res.error()) {
-            spdlog::error("Sushiswap subgraph error: {}", res.error());
-            return false;
-        }
-
-        // Parse the JSON
-        if (document.Parse(res->body.c_str()).HasParseError()) {
-            spdlog::error("Sushiswap subgraph document parse error: {}", res->body.c_str());
-            return false;
+    bool loaded = true;
+    for (size_t i = 0; i < loads.size(); i++) {
+        if (!loads[i].get()) {
+            spdlog::error("Problem loading {} prices", sources_[i]->config().name);
+            loaded = false;
         }
+    }
+    if (!loaded) return false;
 
-        if (!document.IsObject()) {
-            spdlog::error("Sushiswap subgraph  error: {}", "No data");
-            return false;
-        }
-
-        // Put the data int the struct
-        if (document.HasMember("data")) {
-            if (document["data"].HasMember("pairs")) {
-                if (document["data"]["pairs"].IsArray()) {
-                    const rapidjson::Value &pairs = document["data"]["pairs"];
-                    for (rapidjson::SizeType i = 0; i < pairs.Size(); i++) {
-                        Quotes quote;
-                        quote.id = sole::uuid4().str();
-                        quote.protocol = "SUSHISWAP";
-                        quote.poolID = pairs[i]["id"].GetString();
-
-                        // Token 0
-                        quote.token0Symbol = pairs[i]["token0"]["symbol"].GetString();
-                        quote.token0decimals = std::stoi(
-                                pairs[i]["token0"]["decimals"].GetString());
-                        quote.token0Address = pairs[i]["token0"]["id"].GetString();
-                        quote.token0Price =
-                                std::stod(pairs[i]["token0Price"].GetString());
-                        quote.token0derivedETH = std::stod(pairs[i]["token0"]["derivedETH"].GetString());
-
-                        // Token 1
-                        quote.token1Symbol = pairs[i]["token1"]["symbol"].GetString();
-                        quote.token1decimals = std::stoi(
-                                pairs[i]["token1"]["decimals"].GetString());
-                        quote.token1Address = pairs[i]["token1"]["id"].GetString();
-                        quote.token1Price =
-                                std::stod(pairs[i]["token1Price"].GetString());
-                        quote.token1derivedETH = std::stod(pairs[i]["token1"]["derivedETH"].GetString());
-
-//                        if (quote.token0Symbol.empty() || quote.token1Symbol.empty()) {
-//                            spdlog::warn("Sushiswap problem with pair: {}", quote.poolID);
-//                            continue;
-//                        }
-
-                        // Unique ID
-                        quotes[quote.id] = quote;
-                        connections[quote.protocol + "_" + quote.token1Address].emplace_back(quote);
-                        connections[quote.protocol + "_" + quote.token0Address].emplace_back(quote);
-                    }
-                    if (quotes.empty()) {
-                        spdlog::warn("No quotes for sushiswap");
-                        return false;
-                    }
-                } else {
-                    return false;
-                }
-            } else {
-                return false;
-            }
-        } else {
-            return false;
-        }
-        return true;
-    } catch (std::exception &e) {
-        spdlog::error("Sushiswap subgraph parse error: {}", e.what());
+    // Merge the buffers, quote ids are unique across sources as they carry the protocol
+    for (auto &buffer : buffers) {
+        std::move(buffer.begin(), buffer.end(), std::back_inserter(quotes));
     }
-    return false;
-}
\ No newline at end of file
+    return true;
+}
@@ -5,6 +5,11 @@
 
 #define CPPHTTPLIB_OPENSSL_SUPPORT 1
 
+#include <array>
+#include <functional>
+#include <future>
+#include <thread>
+#include <unordered_set>
 #include <spdlog/spdlog.h>
 #include <libwebsockets.h>
 #include <rapidjson/document.h>
@@ -16,60 +21,147 @@
 #include "libs/misc/system.h"
 #include "libs/misc/sole.h"
 #include "libs/misc/elapsed.h"
-#include "libs/misc/md5.h"
+#include "libs/misc/ThreadPool.h"
 #include "libs/match.h"
-#include "libs/graph/directed_edge.h"
-#include "libs/graph/edge_weighted_digraph.h"
+#include "quote_source.h"
+#include "market_graph.h"
+#include "swap_simulator.h"
+#include "pipeline.h"
+#include "scheduler.h"
+#include "sync_subscriber.h"
 #include "libs/graph/bellman_ford_sp.h"
+#include "libs/graph/bellman_ford_solver.h"
+#include "libs/graph/incremental_bellman_ford.h"
+#include "libs/graph/tarjan_scc.h"
+#include "libs/graph/tarjan_cycle_detector.h"
+#include "libs/graph/hop_bounded_cycles.h"
+#include "libs/graph/top_k_cycles.h"
+#include "libs/graph/cycle_key.h"
 
 using namespace std;
 
-struct Quotes {
-    std::string id;
-    std::string protocol;
-    std::string poolID;
-    std::string token0Symbol;
-    std::string token1Symbol;
-    std::string token0Address;
-    std::string token1Address;
-    int64_t token0decimals;
-    int64_t token1decimals;
-    double token0Price;
-    double token1Price;
-    double token0derivedETH;
-    double token1derivedETH;
+// Reply of the node simulation for one candidate
+struct NodeSimulation {
+    bool confirmed = false;     // the node replied with a profit
+    double profit = 0.0;
+    double optimal_volume = 0.0;
 };
 
-struct Arbitrage {
-    std::string currency_return;
-    int64_t decimal_base;
-    double derivedETH;
-    std::vector<std::string> addr;
-    std::vector<std::string> exchange;
-    std::vector<std::string> pool;
-    std::string output;
+enum class DetectionMode {
+    PerSource,      // one Bellman-Ford run per vertex
+    SuperSource,    // single run from a virtual source linked to every vertex
+    Incremental,    // super-source distances kept across cycles, re-relaxed from repriced edges
+    Tarjan,         // super-source search with subtree disassembly
+    HopBounded      // every negative cycle of at most max_hops_ edges
 };
 
 class Streaming {
 private:
     bool system_debug_;
 
-    double initial_volume_ = 0.1;
+    DetectionMode detection_mode_ = DetectionMode::SuperSource;
+
+    // Longest route searched by the hop-bounded detection, 2 to 4 swaps
+    int max_hops_ = 4;
+
+    // Most profitable cycles passed on to the simulation, 0 to pass them all
+    int top_k_ = 10;
+
+    // Searches of a cycle run on these workers, DETECTION_WORKERS of them
+    int detection_workers_ = 1;
+    std::unique_ptr<ThreadPool> detection_pool_;
+
+    // Confirm the chosen operation with the node simulation before executing it
+    bool confirm_simulation_ = true;
+
+    // Best candidates sent to the node simulation, and the connections they go over
+    int confirm_top_ = 8;
+    std::vector<std::unique_ptr<httplib::Client>> simulation_clients_;
+    std::unique_ptr<ThreadPool> simulation_pool_;
 
     httplib::Server server_;
     std::unique_ptr<httplib::Client> nodeRequest_;
-    std::unique_ptr<httplib::SSLClient> graphRequest_;
 
-    bool loadUniSwapPrices(std::unordered_map<std::string, Quotes> &quotes,std::unordered_map<std::string, std::vector<Quotes>> &connections);
+    // DEX subgraphs, each one loaded on its own connection
+    std::vector<std::unique_ptr<SubgraphSource>> sources_;
+
+    // Tokens and pools seen so far, patched by every snapshot
+    MarketGraph market_;
+
+    // Sync logs of the node, pushed to the graph stage between the subgraph snapshots
+    std::unique_ptr<SyncSubscriber> sync_subscriber_;
+    moodycamel::ConcurrentQueue<SyncEvent> sync_events_;
+    std::atomic<bool> sync_reset_{false};       // events may have been missed, the next ingest owes a snapshot
+    int64_t sync_snapshot_ms_ = 60000;          // subgraph snapshot period while subscribed
+    PipelineJob::Clock::time_point next_snapshot_{};
+
+    // Distances of the previous cycle, for the incremental detection
+    std::unique_ptr<IncrementalBellmanFord> detector_;
+
+    // Directory the graph of every cycle is written to, empty to not record
+    std::string graph_record_dir_;
+
+    // Edges of the strong components searched in the current cycle
+    EdgeArena component_arena_;
+
+    // Run the stages one after the other instead of on their own threads
+    bool serial_ = false;
+
+    // Queues between the stages, each drained by the thread of its stage
+    JobQueue graph_queue_;
+    JobQueue detect_queue_;
+    JobQueue size_queue_;
+    JobQueue execute_queue_;
+
+    // The market graph is patched, searched and sized by three stages, in that order.
+    // Its single token is taken by the graph stage and given back by the size stage
+    moodycamel::BlockingConcurrentQueue<int> graph_free_;
 
-    bool loadSushiSwapPrices(std::unordered_map<std::string, Quotes> &quotes,std::unordered_map<std::string, std::vector<Quotes>> &connections);
+    // Starts the checks, SCHEDULE picks the trigger
+    std::unique_ptr<Scheduler> scheduler_;
 
+    std::array<StageStats, kStages> stage_stats_;
+    std::vector<std::thread> stage_threads_;
+    uint64_t snapshots_ = 0;
+
+    bool loadQuotes(std::vector<Quotes> &quotes);
+
+    // Serial check: every stage of one snapshot in turn
     void runCycle();
 
-    void buildEdgeWeightedDigraph(std::vector<DirectedEdge *> &directedEdge,
-                                  std::unordered_map<std::string, Quotes> &quotes,
-                                  std::unordered_map<std::string, std::vector<Quotes>> &connections,
-                                  std::unordered_map<std::string, int> &seq_mapping);
+    // Start a thread per stage and ingest snapshots on the calling one
+    [[noreturn]] void runPipeline();
+
+    // Take the jobs of a stage off its queue, work them, and pass them on to the next queue
+    void runStage(Stage stage, JobQueue &in, JobQueue *out, const std::function<bool(PipelineJob &)> &work);
+
+    // The stages, false to drop the snapshot
+    bool ingest(PipelineJob &job);
+
+    bool updateGraph(PipelineJob &job);
+
+    // Reprice the pools of the Sync events received since the last call
+    void applySyncEvents(GraphDelta &delta);
+
+    bool detect(PipelineJob &job);
+
+    bool sizeCandidates(PipelineJob &job);
+
+    // Time a snapshot spent in, and waiting for, every stage
+    void reportPipeline(const PipelineJob &job);
+
+    // Write the graph in the format read by EdgeWeightedDigraph
+    void recordGraph(const CsrDigraph &csr);
+
+    // Search the non-trivial strong components of the graph on the detection pool
+    void findComponentCycles(const CsrDigraph &csr, std::vector<stack<DirectedEdge *>> &cycles);
+
+    // The /simulation and /trade request for an arbitrage, tagged with id unless negative
+    std::string simulationRequest(const Arbitrage &arb, double starting_volume, int id = -1) const;
+
+    // Post a simulation request, the reply must carry the id of the request if it echoes one
+    static bool nodeSimulation(httplib::Client &client, const std::string &request, int id,
+                               NodeSimulation &simulation);
 
     void simulateArbitrage(const std::vector<Arbitrage> &arbitrages);
 
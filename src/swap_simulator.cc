@@ -0,0 +1,205 @@
+#include "swap_simulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include "libs/match.h"
+
+SwapSimulator::SwapSimulator(const AssetTable &assets) : assets_(assets) {}
+
+double SwapSimulator::getAmountOut(double amount_in, double reserve_in, double reserve_out, double fee) {
+    double amount_in_with_fee = amount_in * (1.0 - fee);
+    return amount_in_with_fee * reserve_out / (reserve_in + amount_in_with_fee);
+}
+
+SwapChain SwapSimulator::chain(const std::stack<DirectedEdge *> &cycle) const {
+    // A swap is out(y) = g * r_out * y / (r_in + g * y) with g = 1 - fee. Feeding it
+    // a * x / (b + c * x) gives g * r_out * a * x / (r_in * b + (r_in * c + g * a) * x)
+    SwapChain chain{1.0, 1.0, 0.0};
+    for (std::stack<DirectedEdge *> edges(cycle); !edges.empty(); edges.pop()) {
+        const DirectedEdge &edge = *edges.top();
+        const Pool &pool = assets_.pool(edge);
+        double reserve_in = edge.zero_for_one() ? pool.reserve0 : pool.reserve1;
+        double reserve_out = edge.zero_for_one() ? pool.reserve1 : pool.reserve0;
+        if (!(reserve_in > 0.0 && reserve_out > 0.0)) return SwapChain{};
+        double g = 1.0 - pool.fee;
+        chain.c = reserve_in * chain.c + g * chain.a;
+        chain.a = g * reserve_out * chain.a;
+        chain.b = reserve_in * chain.b;
+
+        // Scaled back to b = 1 at every hop, the products of the reserves of a long cycle would overflow
+        chain.a /= chain.b;
+        chain.c /= chain.b;
+        chain.b = 1.0;
+    }
+    return cycle.empty() ? SwapChain{} : chain;
+}
+
+SwapSimulation SwapSimulator::simulate(const std::stack<DirectedEdge *> &cycle, double amount_in) const {
+    SwapChain mobius = chain(cycle);
+    SwapSimulation simulation;
+    simulation.amount_in = amount_in;
+    simulation.amount_out = mobius.a * amount_in / (mobius.b + mobius.c * amount_in);
+    return simulation;
+}
+
+SwapSimulation SwapSimulator::optimize(const std::stack<DirectedEdge *> &cycle) const {
+    // The profit a * x / (b + c * x) - x is concave, its derivative a * b / (b + c * x)^2 - 1
+    // vanishes at x = (sqrt(a * b) - b) / c, positive only when a > b. The roots are taken apart
+    // so that the product cannot overflow
+    SwapChain mobius = chain(cycle);
+    SwapSimulation simulation;
+    if (!(mobius.a > mobius.b)) return simulation;
+    simulation.amount_in = (std::sqrt(mobius.a) * std::sqrt(mobius.b) - mobius.b) / mobius.c;
+    simulation.amount_out = mobius.a * simulation.amount_in / (mobius.b + mobius.c * simulation.amount_in);
+    return simulation;
+}
+
+SwapSimulation SwapSimulator::verify(const std::stack<DirectedEdge *> &cycle, double amount_in) const {
+    SwapSimulation simulation;
+    if (cycle.empty() || !(amount_in > 0.0)) return simulation;
+
+    const Asset &first = assets_.from(*cycle.top());
+    const double scale = std::pow(10.0, static_cast<double>(first.decimals));
+    const utils::uint256 amount_in_raw = utils::uint256::fromDouble(amount_in * scale);
+
+    utils::uint256 amount = amount_in_raw;
+    for (std::stack<DirectedEdge *> edges(cycle); !edges.empty(); edges.pop()) {
+        const DirectedEdge &edge = *edges.top();
+        const Pool &pool = assets_.pool(edge);
+        const utils::uint256 &reserve_in = edge.zero_for_one() ? pool.reserve0Raw : pool.reserve1Raw;
+        const utils::uint256 &reserve_out = edge.zero_for_one() ? pool.reserve1Raw : pool.reserve0Raw;
+        if (reserve_in.isZero() || reserve_out.isZero()) return simulation;
+        // the fee in basis points, 0.3% is the 997 / 1000 of the Uniswap V2 contracts
+        auto fee_numerator = static_cast<uint64_t>(std::llround((1.0 - pool.fee) * 10000.0));
+        amount = ::getAmountOut(amount, reserve_in, reserve_out, fee_numerator, 10000);
+    }
+
+    simulation.amount_in = amount_in_raw.toDouble() / scale;
+    simulation.amount_out = amount.toDouble() / scale;
+    return simulation;
+}
+
+void SwapSimulator::optimize(const std::vector<std::stack<DirectedEdge *>> &cycles,
+                             std::vector<SwapSimulation> &simulations) const {
+    size_t n = cycles.size();
+    a_.resize(n);
+    b_.resize(n);
+    c_.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        SwapChain mobius = chain(cycles[i]);
+        a_[i] = mobius.a;
+        b_[i] = mobius.b;
+        c_[i] = mobius.c > 0.0 ? mobius.c : 1.0;   // a zero chain, sized to nothing below
+    }
+
+    // Branch-free over the arrays so that the compiler can vectorise the square roots;
+    // cycles that do not pay their fees are clamped to an input of zero
+    simulations.resize(n);
+    const double *a = a_.data();
+    const double *b = b_.data();
+    const double *c = c_.data();
+    for (size_t i = 0; i < n; i++) {
+        double x = std::max(0.0, (std::sqrt(a[i]) * std::sqrt(b[i]) - b[i]) / c[i]);
+        simulations[i].amount_in = x;
+        simulations[i].amount_out = a[i] * x / (b[i] + c[i] * x);
+    }
+}
+
+/**
+ * Sizing throughput of the closed form against a golden-section search on the
+ * profit, over random cycles of 2 to 4 pools.
+ *
+ * Compilation:  clang++ -O2 -c libs/graph/asset_table.cc libs/graph/directed_edge.cc -std=c++17
+ *               clang++ -O2 -DDebug swap_simulator.cc asset_table.o directed_edge.o -Ilibs/graph -std=c++17 -o swap_simulator
+ * Execution:    ./swap_simulator [cycles]
+ */
+#ifdef Debug
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+
+// The golden-section search the closed form replaced, kept for comparison only
+static double goldenSection(const SwapSimulator &simulator, const std::stack<DirectedEdge *> &cycle, double hi) {
+    const double phi = (std::sqrt(5.0) - 1.0) / 2.0;
+    double lo = 0.0;
+    auto profit = [&](double x) { return simulator.simulate(cycle, x).profit(); };
+    double x1 = hi - phi * (hi - lo);
+    double x2 = lo + phi * (hi - lo);
+    double f1 = profit(x1);
+    double f2 = profit(x2);
+    for (int i = 0; i < 100; i++) {
+        if (f1 < f2) {
+            lo = x1;
+            x1 = x2;
+            f1 = f2;
+            x2 = lo + phi * (hi - lo);
+            f2 = profit(x2);
+        } else {
+            hi = x2;
+            x2 = x1;
+            f2 = f1;
+            x1 = hi - phi * (hi - lo);
+            f1 = profit(x1);
+        }
+    }
+    return (lo + hi) / 2.0;
+}
+
+int main(int argc, char *argv[]) {
+    int n = argc > 1 ? std::stoi(argv[1]) : 100000;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> reserve(1e3, 1e6);
+    std::uniform_real_distribution<double> skew(0.97, 1.03);
+
+    // One token per hop, every pool priced close to the previous one so that some cycles pay
+    AssetTable assets;
+    std::vector<std::unique_ptr<DirectedEdge>> edges;
+    std::vector<std::stack<DirectedEdge *>> cycles(n);
+    for (int i = 0; i < n; i++) {
+        int hops = 2 + static_cast<int>(rng() % 3);
+        std::vector<DirectedEdge *> path;
+        for (int h = 0; h < hops; h++) {
+            Asset token;
+            token.address = std::to_string(i) + "-" + std::to_string(h);
+            Pool pool;
+            pool.quoteId = token.address;
+            pool.token0 = assets.addAsset("BENCH", token);
+            pool.token1 = pool.token0;
+            pool.reserve0 = reserve(rng);
+            pool.reserve1 = pool.reserve0 * skew(rng);
+            pool.fee = 0.003;
+            uint32_t id = assets.addPool(pool);
+            edges.emplace_back(std::make_unique<DirectedEdge>(h, (h + 1) % hops, 0.0, id, true));
+            path.emplace_back(edges.back().get());
+        }
+        for (auto e = path.rbegin(); e != path.rend(); ++e) cycles[i].push(*e);
+    }
+
+    SwapSimulator simulator(assets);
+    std::vector<SwapSimulation> simulations;
+    auto start = std::chrono::steady_clock::now();
+    simulator.optimize(cycles, simulations);
+    double closed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    int profitable = 0;
+    double worst = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < n; i++) {
+        if (simulations[i].amount_in <= 0.0) continue;
+        profitable++;
+        double hi = assets.pool(cycles[i].top()->pool()).reserve0;
+        double x = goldenSection(simulator, cycles[i], hi);
+        double gap = simulations[i].profit() - simulator.simulate(cycles[i], x).profit();
+        worst = std::min(worst, gap);
+    }
+    double golden = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    printf("closed form   : %8.1f ns per cycle\n", closed / n);
+    printf("golden section: %8.1f ns per profitable cycle\n", profitable ? golden / profitable : 0.0);
+    printf("%d of %d cycles profitable, closed form behind by at most %g\n", profitable, n, -worst);
+    return 0;
+}
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stack>
+#include <vector>
+#include "libs/graph/directed_edge.h"
+#include "libs/graph/asset_table.h"
+
+// An amount pushed around a cycle, in units of the first token of the cycle
+struct SwapSimulation {
+    double amount_in = 0.0;
+    double amount_out = 0.0;
+
+    double profit() const { return amount_out - amount_in; }
+};
+
+// A chain of constant-product swaps composes into the Mobius transform
+// out(x) = a * x / (b + c * x), with a > b when the cycle pays its fees
+struct SwapChain {
+    double a = 0.0;
+    double b = 1.0;
+    double c = 0.0;
+};
+
+// Replays cycles against the reserves of their pools, x*y=k with the fee of every pool,
+// in place of the /simulation round trip to the node
+class SwapSimulator {
+private:
+    const AssetTable &assets_;
+
+    // The chains of a batch, structure of arrays for the sizing loop
+    mutable std::vector<double> a_;
+    mutable std::vector<double> b_;
+    mutable std::vector<double> c_;
+
+public:
+    explicit SwapSimulator(const AssetTable &assets);
+
+    // Output of a constant-product pool for amount_in, the fee taken from the input
+    static double getAmountOut(double amount_in, double reserve_in, double reserve_out, double fee);
+
+    // Compose the swaps of the cycle, a zero chain if a pool has no reserves
+    SwapChain chain(const std::stack<DirectedEdge *> &cycle) const;
+
+    // Amount of the first token back after swapping amount_in of it along the cycle
+    SwapSimulation simulate(const std::stack<DirectedEdge *> &cycle, double amount_in) const;
+
+    // The input of the largest profit, zero if the cycle does not pay its fees
+    SwapSimulation optimize(const std::stack<DirectedEdge *> &cycle) const;
+
+    // Replay amount_in along the cycle in integers, rounding like the pools do on chain.
+    // The double paths above screen the candidates, this is the final check of one
+    SwapSimulation verify(const std::stack<DirectedEdge *> &cycle, double amount_in) const;
+
+    // The optimal input of every cycle, in one pass over the chains
+    void optimize(const std::vector<std::stack<DirectedEdge *>> &cycles,
+                  std::vector<SwapSimulation> &simulations) const;
+};
@@ -0,0 +1,322 @@
+#include "sync_subscriber.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <vector>
+#include <spdlog/spdlog.h>
+#include <rapidjson/document.h>
+
+namespace {
+    // Hex quantity of a JSON-RPC reply, 0 if missing or malformed
+    uint64_t hexQuantity(const rapidjson::Value &value, const char *name) {
+        if (!value.HasMember(name) || !value[name].IsString()) return 0;
+        return std::strtoull(value[name].GetString(), nullptr, 16);
+    }
+
+    // Send a text message, the buffer has LWS_PRE bytes of room for the frame header
+    bool writeText(struct lws *wsi, const std::string &text) {
+        std::vector<unsigned char> buffer(LWS_PRE + text.size());
+        memcpy(buffer.data() + LWS_PRE, text.data(), text.size());
+        return lws_write(wsi, buffer.data() + LWS_PRE, text.size(), LWS_WRITE_TEXT) >= static_cast<int>(text.size());
+    }
+}
+
+SyncSubscriber::SyncSubscriber(SyncSource config, std::function<void(SyncEvent &&)> on_sync,
+                               std::function<void()> on_reset)
+        : config_(std::move(config)), on_sync_(std::move(on_sync)), on_reset_(std::move(on_reset)) {
+    config_.retry_ms = std::max<int64_t>(1, config_.retry_ms);
+}
+
+SyncSubscriber::~SyncSubscriber() {
+    running_ = false;
+    if (context_) lws_cancel_service(context_);
+    if (thread_.joinable()) thread_.join();
+    if (context_) lws_context_destroy(context_);
+}
+
+void SyncSubscriber::start() {
+    static const struct lws_protocols protocols[] = {
+            {"sync", &SyncSubscriber::callback, 0, 1 << 16},
+            {nullptr, nullptr, 0, 0}
+    };
+
+    if (!config_.record_file.empty()) {
+        record_.open(config_.record_file, std::ios::app);
+    }
+
+    lws_set_log_level(LLL_ERR | LLL_WARN, nullptr);
+    struct lws_context_creation_info info;
+    memset(&info, 0, sizeof(info));
+    info.port = CONTEXT_PORT_NO_LISTEN;
+    info.protocols = protocols;
+    info.user = this;
+    if (config_.tls) info.options |= LWS_SERVER_OPTION_DO_SSL_GLOBAL_INIT;
+    context_ = lws_create_context(&info);
+    if (!context_) {
+        spdlog::error("Sync subscriber: could not create the websocket context");
+        return;
+    }
+
+    // The context is only touched by its service thread from here on
+    running_ = true;
+    thread_ = std::thread([this]() { run(); });
+}
+
+void SyncSubscriber::run() {
+    while (running_) {
+        if (!wsi_ && std::chrono::steady_clock::now() >= retry_at_) {
+            connect();
+        }
+        lws_service(context_, 100);
+    }
+}
+
+void SyncSubscriber::connect() {
+    struct lws_client_connect_info info;
+    memset(&info, 0, sizeof(info));
+    info.context = context_;
+    info.address = config_.host.c_str();
+    info.port = config_.port;
+    info.path = config_.path.c_str();
+    info.host = info.address;
+    info.origin = info.address;
+    info.ssl_connection = config_.tls ? LCCSCF_USE_SSL : 0;
+    info.pwsi = &wsi_;
+
+    retry_at_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(config_.retry_ms);
+    if (!lws_client_connect_via_info(&info)) {
+        spdlog::error("Sync subscriber: could not connect to {}:{}{}", config_.host, config_.port, config_.path);
+    }
+}
+
+int SyncSubscriber::callback(struct lws *wsi, enum lws_callback_reasons reason, void *user, void *in, size_t len) {
+    auto *self = static_cast<SyncSubscriber *>(lws_context_user(lws_get_context(wsi)));
+    switch (reason) {
+        case LWS_CALLBACK_CLIENT_ESTABLISHED:
+            spdlog::info("Sync subscriber connected to {}:{}{}", self->config_.host, self->config_.port,
+                         self->config_.path);
+            self->subscribed_ = false;
+            self->message_.clear();
+            lws_callback_on_writable(wsi);
+            break;
+
+        case LWS_CALLBACK_CLIENT_WRITEABLE:
+            if (!self->subscribed_) {
+                if (!writeText(wsi, subscribeRequest(1))) return -1;
+                self->subscribed_ = true;
+            }
+            break;
+
+        case LWS_CALLBACK_CLIENT_RECEIVE:
+            // A message may come in several fragments
+            self->message_.append(static_cast<const char *>(in), len);
+            if (lws_is_final_fragment(wsi) && lws_remaining_packet_payload(wsi) == 0) {
+                self->onMessage(self->message_);
+                self->message_.clear();
+            }
+            break;
+
+        case LWS_CALLBACK_CLIENT_CONNECTION_ERROR:
+            spdlog::error("Sync subscriber connection error: {}",
+                          in ? std::string(static_cast<const char *>(in), len) : "unknown");
+            // fall through
+        case LWS_CALLBACK_CLIENT_CLOSED:
+            if (reason == LWS_CALLBACK_CLIENT_CLOSED) {
+                spdlog::warn("Sync subscriber disconnected, reconnecting in {} ms", self->config_.retry_ms);
+            }
+            self->wsi_ = nullptr;
+            self->retry_at_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(self->config_.retry_ms);
+            self->reconnects_++;
+            if (self->on_reset_) self->on_reset_();
+            break;
+
+        default:
+            break;
+    }
+    return lws_callback_http_dummy(wsi, reason, user, in, len);
+}
+
+void SyncSubscriber::onMessage(const std::string &message) {
+    SyncEvent event;
+    if (parseNotification(message.c_str(), message.size(), event)) {
+        events_++;
+        if (record_.is_open()) record_ << message << '\n';
+        if (on_sync_) on_sync_(std::move(event));
+        return;
+    }
+
+    // Anything else is the reply to the subscription request
+    rapidjson::Document document;
+    if (document.Parse(message.c_str(), message.size()).HasParseError() || !document.IsObject()) {
+        spdlog::error("Sync subscriber: unexpected message {}", message);
+    } else if (document.HasMember("error")) {
+        spdlog::error("Sync subscription refused: {}", message);
+    } else if (document.HasMember("result") && document["result"].IsString()) {
+        spdlog::info("Subscribed to the Sync logs, subscription {}", document["result"].GetString());
+    }
+}
+
+std::string SyncSubscriber::subscribeRequest(int id) {
+    return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) +
+           R"(,"method":"eth_subscribe","params":["logs",{"topics":[")" + kSyncTopic + R"("]}]})";
+}
+
+bool SyncSubscriber::parseNotification(const char *json, size_t length, SyncEvent &event) {
+    rapidjson::Document document;
+    if (document.Parse(json, length).HasParseError() || !document.IsObject()) return false;
+    if (!document.HasMember("method") || !document["method"].IsString() ||
+        strcmp(document["method"].GetString(), "eth_subscription") != 0) {
+        return false;
+    }
+    if (!document.HasMember("params") || !document["params"].IsObject()) return false;
+    const rapidjson::Value &params = document["params"];
+    if (!params.HasMember("result") || !params["result"].IsObject()) return false;
+    const rapidjson::Value &log = params["result"];
+
+    if (!log.HasMember("topics") || !log["topics"].IsArray() || log["topics"].Size() == 0) return false;
+    const rapidjson::Value &topic = *log["topics"].Begin();
+    if (!topic.IsString() || strcasecmp(topic.GetString(), kSyncTopic) != 0) return false;
+    if (!log.HasMember("address") || !log["address"].IsString()) return false;
+    if (!log.HasMember("data") || !log["data"].IsString()) return false;
+
+    // Two uint112 reserves, each in a 32-byte word
+    const char *data = log["data"].GetString();
+    if (log["data"].GetStringLength() != 2 + 128) return false;
+    if (!utils::uint256::fromHex(data + 2, 64, event.reserve0) ||
+        !utils::uint256::fromHex(data + 66, 64, event.reserve1)) {
+        return false;
+    }
+
+    event.pair = log["address"].GetString();
+    event.block = hexQuantity(log, "blockNumber");
+    event.log_index = hexQuantity(log, "logIndex");
+    event.removed = log.HasMember("removed") && log["removed"].IsBool() && log["removed"].GetBool();
+    return true;
+}
+
+/**
+ * A stand-in node serving recorded Sync notifications, as written to SYNC_RECORD_FILE,
+ * to any client subscribing to logs, and a client printing the Sync events of a node.
+ * Point the subscriber of the streaming processor at the first to replay a session.
+ *
+ * Compilation:  clang++ -O2 -DDebug sync_subscriber.cc -std=c++17 -lwebsockets -lspdlog -lfmt -lpthread -o sync_subscriber
+ * Execution:    ./sync_subscriber replay sync.log [port] [interval_ms]
+ *               ./sync_subscriber listen [host] [port]
+ */
+#ifdef Debug
+
+#include <iostream>
+
+struct Replay {
+    std::vector<std::string> notifications;
+    int interval_ms;
+};
+
+// State of one subscriber of the stand-in node
+struct ReplaySession {
+    size_t next;                // next notification to send
+    int request_id;
+    bool reply_pending;         // the subscription request is not answered yet
+    bool subscribed;
+};
+
+static int replayCallback(struct lws *wsi, enum lws_callback_reasons reason, void *user, void *in, size_t len) {
+    auto *replay = static_cast<Replay *>(lws_context_user(lws_get_context(wsi)));
+    auto *session = static_cast<ReplaySession *>(user);
+    switch (reason) {
+        case LWS_CALLBACK_ESTABLISHED:
+            *session = ReplaySession{0, 0, false, false};
+            break;
+
+        case LWS_CALLBACK_RECEIVE: {
+            rapidjson::Document document;
+            if (document.Parse(static_cast<const char *>(in), len).HasParseError() || !document.IsObject()) break;
+            session->request_id = document.HasMember("id") && document["id"].IsInt() ? document["id"].GetInt() : 1;
+            session->reply_pending = true;
+            lws_callback_on_writable(wsi);
+            break;
+        }
+
+        case LWS_CALLBACK_SERVER_WRITEABLE:
+            if (session->reply_pending) {
+                std::string reply = R"({"jsonrpc":"2.0","id":)" + std::to_string(session->request_id) +
+                                    R"(,"result":"0x1"})";
+                if (!writeText(wsi, reply)) return -1;
+                session->reply_pending = false;
+                session->subscribed = true;
+            } else if (session->subscribed && session->next < replay->notifications.size()) {
+                if (!writeText(wsi, replay->notifications[session->next++])) return -1;
+                if (session->next == replay->notifications.size()) {
+                    printf("replayed %zu notifications\n", session->next);
+                    break;
+                }
+            } else {
+                break;
+            }
+            lws_set_timer_usecs(wsi, static_cast<lws_usec_t>(replay->interval_ms) * 1000);
+            break;
+
+        case LWS_CALLBACK_TIMER:
+            lws_callback_on_writable(wsi);
+            break;
+
+        default:
+            break;
+    }
+    return lws_callback_http_dummy(wsi, reason, user, in, len);
+}
+
+static int serve(const char *file, int port, int interval_ms) {
+    Replay replay{{}, interval_ms};
+    std::ifstream in(file);
+    for (std::string line; std::getline(in, line);) {
+        if (!line.empty()) replay.notifications.emplace_back(std::move(line));
+    }
+    printf("serving %zu notifications on port %d, %d ms apart\n", replay.notifications.size(), port, interval_ms);
+
+    static const struct lws_protocols protocols[] = {
+            {"replay", replayCallback, sizeof(ReplaySession), 1 << 16},
+            {nullptr, nullptr, 0, 0}
+    };
+    struct lws_context_creation_info info;
+    memset(&info, 0, sizeof(info));
+    info.port = port;
+    info.protocols = protocols;
+    info.user = &replay;
+    struct lws_context *context = lws_create_context(&info);
+    if (!context) return 1;
+    while (lws_service(context, 100) >= 0);
+    lws_context_destroy(context);
+    return 0;
+}
+
+static int subscribe(const char *host, int port) {
+    SyncSource source;
+    source.host = host;
+    source.port = port;
+    SyncSubscriber subscriber(source, [](SyncEvent &&event) {
+        printf("block %llu log %llu %s reserve0 %s reserve1 %s%s\n",
+               static_cast<unsigned long long>(event.block), static_cast<unsigned long long>(event.log_index),
+               event.pair.c_str(), event.reserve0.toString().c_str(), event.reserve1.toString().c_str(),
+               event.removed ? " removed" : "");
+    }, []() {
+        printf("connection lost\n");
+    });
+    subscriber.start();
+    while (true) std::this_thread::sleep_for(std::chrono::seconds(1));
+}
+
+int main(int argc, char *argv[]) {
+    std::string mode = argc > 1 ? argv[1] : "";
+    if (mode == "replay" && argc > 2) {
+        return serve(argv[2], argc > 3 ? std::stoi(argv[3]) : 8546, argc > 4 ? std::stoi(argv[4]) : 100);
+    }
+    if (mode == "listen") {
+        return subscribe(argc > 2 ? argv[2] : "localhost", argc > 3 ? std::stoi(argv[3]) : 8546);
+    }
+    std::cerr << "usage: sync_subscriber replay sync.log [port] [interval_ms] | listen [host] [port]" << std::endl;
+    return 1;
+}
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <libwebsockets.h>
+#include "libs/misc/uint256.h"
+
+// keccak256("Sync(uint112,uint112)"), emitted by a Uniswap V2 pair, and its forks, on every reserve change
+constexpr const char *kSyncTopic = "0x1c411e9a96e071241c2f21f7726b17ae89e3cab4c78be50e062b03a9fffbbad1";
+
+// The reserves of a pair after a swap, mint or burn
+struct SyncEvent {
+    std::string pair;                   // address of the pair, as the node sent it
+    utils::uint256 reserve0;            // in the smallest unit of the tokens, as on chain
+    utils::uint256 reserve1;
+    uint64_t block = 0;
+    uint64_t log_index = 0;
+    bool removed = false;               // the log was reverted by a reorg
+};
+
+// Where to subscribe to the Sync logs
+struct SyncSource {
+    std::string host = "localhost";     // websocket JSON-RPC endpoint of the node
+    int port = 8546;
+    std::string path = "/";
+    bool tls = false;
+    std::string record_file;            // append every notification to this file, empty to not record
+    int64_t retry_ms = 1000;            // wait before reconnecting
+};
+
+// Subscribes to the Sync logs of every pair over eth_subscribe and decodes their reserves.
+// The connection is served on a thread of its own, the events are handed to on_sync on that
+// thread in the order of the chain; on_reset is called whenever the connection was lost, as
+// events may have been missed until it is back.
+class SyncSubscriber {
+private:
+    SyncSource config_;
+    std::function<void(SyncEvent &&)> on_sync_;
+    std::function<void()> on_reset_;
+
+    struct lws_context *context_ = nullptr;
+    struct lws *wsi_ = nullptr;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::string message_;               // fragments of the message being received
+    bool subscribed_ = false;           // the subscription request went out on this connection
+    std::chrono::steady_clock::time_point retry_at_;
+    std::ofstream record_;
+
+    std::atomic<uint64_t> events_{0};
+    std::atomic<uint64_t> reconnects_{0};
+
+    void connect();
+
+    void run();
+
+    void onMessage(const std::string &message);
+
+    static int callback(struct lws *wsi, enum lws_callback_reasons reason, void *user, void *in, size_t len);
+
+public:
+    SyncSubscriber(SyncSource config, std::function<void(SyncEvent &&)> on_sync, std::function<void()> on_reset);
+
+    ~SyncSubscriber();
+
+    const SyncSource &config() const { return config_; }
+
+    // Connect and serve the subscription until destroyed
+    void start();
+
+    // The eth_subscribe request for the Sync logs
+    static std::string subscribeRequest(int id);
+
+    // Decode an eth_subscription notification of a Sync log, false for any other message
+    static bool parseNotification(const char *json, size_t length, SyncEvent &event);
+
+    uint64_t events() const { return events_; }
+
+    uint64_t reconnects() const { return reconnects_; }
+};